@@ -0,0 +1,421 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+// bench_run: cost of one run() call across block sizes, tempos, step
+// resolutions, pattern densities and LED refresh load.
+//
+// The plugin sources are linked in statically and driven through the test
+// host. Each case gets a fresh instance, fills the pattern, starts the
+// transport and times every block over a fixed stretch of audio. Results
+// can be written as a CSV baseline and later compared against it.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2_host.h"
+#include "grid_seq/common.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SAMPLE_RATE 48000.0
+#define ATOM_CAPACITY 65536
+#define MAX_CASES 1024
+
+// Port indices from ttl/grid_seq.ttl
+enum {
+    PORT_MIDI_IN = 0,
+    PORT_MIDI_OUT = 1,
+    PORT_LAUNCHPAD_OUT = 2,
+    PORT_GRID_X = 3,
+    PORT_GRID_Y = 4,
+    PORT_CURRENT_STEP = 5,
+    PORT_GRID_CHANGED = 6,
+    PORT_NOTIFY = 7,
+    PORT_GRID_ROW_0 = 8,
+    PORT_SEQUENCE_LENGTH = 24,
+    PORT_MIDI_FILTER = 25,
+    PORT_STEPS_PER_BEAT = 26
+};
+
+typedef enum {
+    LED_LOAD_STEP = 0,   // LEDs refresh on step changes only
+    LED_LOAD_BLOCK       // A pad press every block forces a full refresh
+} LedLoad;
+
+static const char* const led_load_names[] = {"step", "block"};
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t bpm;
+    uint32_t steps_per_beat;
+    uint32_t density;    // Number of set cells (0-2048)
+    LedLoad led_load;
+} BenchCase;
+
+typedef struct {
+    uint32_t blocks;
+    uint64_t min_ns;
+    uint64_t median_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t events;
+    double events_per_sec;   // Output events per second of audio
+    double load;             // Time in run() / audio time, in percent
+} BenchResult;
+
+static const uint32_t block_sizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+static const uint32_t tempos[] = {60, 120, 240, 480};
+static const uint32_t resolutions[] = {1, 2, 4};
+static const uint32_t densities[] = {0, 64, 512, 2048};
+
+static const uint32_t quick_block_sizes[] = {64, 1024};
+static const uint32_t quick_tempos[] = {120};
+static const uint32_t quick_resolutions[] = {4};
+static const uint32_t quick_densities[] = {0, 2048};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "\n"
+        "  -q         Quick sweep (a few representative cases)\n"
+        "  -d SEC     Seconds of audio timed per case (default 4)\n"
+        "  -o FILE    Write results as a CSV baseline\n"
+        "  -c FILE    Compare against a CSV baseline, fail on regressions\n"
+        "  -t PCT     Allowed median/p99 slowdown for -c (default 25)\n",
+        prog);
+}
+
+static void send_cc(LV2Host* host, uint8_t cc, uint8_t value) {
+    const uint8_t msg[3] = {0xB0, cc, value};
+    host_send_midi(host, 0, msg, 3);
+}
+
+static void press_pad(LV2Host* host, uint8_t x, uint8_t y) {
+    uint8_t note = (uint8_t)(11 + x + y * 10);
+    const uint8_t on[3] = {0x90, note, 127};
+    const uint8_t off[3] = {0x90, note, 0};
+
+    host_send_midi(host, 0, on, 3);
+    host_send_midi(host, 0, off, 3);
+}
+
+static bool setup_plugin(LV2Host* host, const BenchCase* bc) {
+    memset(host, 0, sizeof(LV2Host));
+    host_init(host, lv2_descriptor(0), SAMPLE_RATE);
+
+    host_add_port(host, PORT_MIDI_IN, HOST_PORT_ATOM_IN, "midi_in", ATOM_CAPACITY);
+    host_add_port(host, PORT_MIDI_OUT, HOST_PORT_ATOM_OUT, "midi_out", ATOM_CAPACITY);
+    host_add_port(host, PORT_LAUNCHPAD_OUT, HOST_PORT_ATOM_OUT, "launchpad_out", ATOM_CAPACITY);
+    host_add_port(host, PORT_NOTIFY, HOST_PORT_ATOM_OUT, "notify", ATOM_CAPACITY);
+    host_add_port(host, PORT_GRID_X, HOST_PORT_CONTROL, "grid_x", 0);
+    host_add_port(host, PORT_GRID_Y, HOST_PORT_CONTROL, "grid_y", 0);
+    host_add_port(host, PORT_CURRENT_STEP, HOST_PORT_CONTROL, "current_step", 0);
+    host_add_port(host, PORT_GRID_CHANGED, HOST_PORT_CONTROL, "grid_changed", 0);
+    for (uint32_t i = 0; i < MAX_GRID_SIZE; i++) {
+        host_add_port(host, PORT_GRID_ROW_0 + i, HOST_PORT_CONTROL, "grid_row", 0);
+    }
+    host_add_port(host, PORT_SEQUENCE_LENGTH, HOST_PORT_CONTROL, "sequence_length", 0);
+    host_add_port(host, PORT_MIDI_FILTER, HOST_PORT_CONTROL, "midi_filter", 0);
+    host_add_port(host, PORT_STEPS_PER_BEAT, HOST_PORT_CONTROL, "steps_per_beat", 0);
+
+    host_set_control(host, PORT_GRID_X, -1.0f);
+    host_set_control(host, PORT_GRID_Y, -1.0f);
+    host_set_control(host, PORT_SEQUENCE_LENGTH, MAX_SEQUENCE_LENGTH);
+    host_set_control(host, PORT_MIDI_FILTER, 0.0f);
+    host_set_control(host, PORT_STEPS_PER_BEAT, (float)bc->steps_per_beat);
+
+    // Only timing and event counts are needed, not the events themselves
+    host_record(host, PORT_MIDI_OUT, false);
+    host_record(host, PORT_LAUNCHPAD_OUT, false);
+    host_record(host, PORT_NOTIFY, false);
+
+    if (!host_instantiate(host)) return false;
+    host_activate(host);
+    return true;
+}
+
+// Set the first density cells, spread across all steps (cell i is step
+// i % 16, note i / 16), using UI toggles within 8-note pitch windows.
+static void fill_pattern(LV2Host* host, uint32_t density) {
+    // Move the pitch window down to note 0
+    for (uint32_t i = 0; i < DEFAULT_PITCH_OFFSET; i++) {
+        send_cc(host, 91, 127);
+    }
+    host_run(host, 64);
+
+    for (uint32_t i = 0; i < density; i++) {
+        uint32_t step = i % MAX_SEQUENCE_LENGTH;
+        uint32_t note = i / MAX_SEQUENCE_LENGTH;
+
+        // Next pitch window every 8 notes
+        if (step == 0 && note > 0 && note % GRID_VISIBLE_ROWS == 0) {
+            for (uint32_t j = 0; j < GRID_VISIBLE_ROWS; j++) {
+                send_cc(host, 92, 127);
+            }
+            host_run(host, 64);
+        }
+
+        host_set_control(host, PORT_GRID_X, (float)step);
+        host_set_control(host, PORT_GRID_Y, (float)(note % GRID_VISIBLE_ROWS));
+        host_run(host, 64);
+    }
+
+    host_set_control(host, PORT_GRID_X, -1.0f);
+    host_set_control(host, PORT_GRID_Y, -1.0f);
+    host_run(host, 64);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static bool run_case(const BenchCase* bc, double seconds, BenchResult* result) {
+    LV2Host host;
+    if (!setup_plugin(&host, bc)) {
+        host_free(&host);
+        return false;
+    }
+
+    fill_pattern(&host, bc->density);
+
+    // Start the transport and play one full sequence to warm up
+    host_send_position(&host, 0, (float)bc->bpm, 1.0f);
+    uint64_t frames_per_step = (uint64_t)(60.0 / bc->bpm * SAMPLE_RATE / bc->steps_per_beat);
+    host_run_frames(&host, frames_per_step * MAX_SEQUENCE_LENGTH, bc->block_size);
+
+    uint32_t blocks = (uint32_t)(seconds * SAMPLE_RATE / bc->block_size);
+    if (blocks < 16) blocks = 16;
+
+    uint64_t* samples = (uint64_t*)malloc(blocks * sizeof(uint64_t));
+    if (!samples) {
+        host_free(&host);
+        return false;
+    }
+
+    uint64_t total_ns = 0;
+    memset(result, 0, sizeof(BenchResult));
+
+    for (uint32_t i = 0; i < blocks; i++) {
+        if (bc->led_load == LED_LOAD_BLOCK) {
+            // Toggle a cell twice: pattern unchanged, LEDs marked dirty
+            press_pad(&host, 0, 7);
+            press_pad(&host, 0, 7);
+        }
+
+        host_run(&host, bc->block_size);
+        samples[i] = host.run_ns;
+        total_ns += host.run_ns;
+        result->events += host.block_events;
+    }
+
+    qsort(samples, blocks, sizeof(uint64_t), compare_u64);
+
+    double audio_seconds = (double)blocks * bc->block_size / SAMPLE_RATE;
+    result->blocks = blocks;
+    result->min_ns = samples[0];
+    result->median_ns = samples[blocks / 2];
+    result->p99_ns = samples[(uint32_t)((blocks - 1) * 0.99)];
+    result->max_ns = samples[blocks - 1];
+    result->events_per_sec = (double)result->events / audio_seconds;
+    result->load = (double)total_ns / (audio_seconds * 1e9) * 100.0;
+
+    free(samples);
+    host_free(&host);
+    return true;
+}
+
+static size_t build_cases(BenchCase* cases, bool quick) {
+    const uint32_t* bs = quick ? quick_block_sizes : block_sizes;
+    const uint32_t* tp = quick ? quick_tempos : tempos;
+    const uint32_t* rs = quick ? quick_resolutions : resolutions;
+    const uint32_t* ds = quick ? quick_densities : densities;
+    size_t n_bs = quick ? COUNT(quick_block_sizes) : COUNT(block_sizes);
+    size_t n_tp = quick ? COUNT(quick_tempos) : COUNT(tempos);
+    size_t n_rs = quick ? COUNT(quick_resolutions) : COUNT(resolutions);
+    size_t n_ds = quick ? COUNT(quick_densities) : COUNT(densities);
+
+    size_t count = 0;
+    for (size_t b = 0; b < n_bs; b++) {
+        for (size_t t = 0; t < n_tp; t++) {
+            for (size_t r = 0; r < n_rs; r++) {
+                for (size_t d = 0; d < n_ds; d++) {
+                    for (int l = LED_LOAD_STEP; l <= LED_LOAD_BLOCK; l++) {
+                        if (count == MAX_CASES) return count;
+                        cases[count++] = (BenchCase){bs[b], tp[t], rs[r], ds[d], (LedLoad)l};
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+static void format_key(const BenchCase* bc, char* buf, size_t size) {
+    snprintf(buf, size, "%u,%u,%u,%u,%s", bc->block_size, bc->bpm, bc->steps_per_beat,
+             bc->density, led_load_names[bc->led_load]);
+}
+
+static bool write_csv(const char* path, const BenchCase* cases, const BenchResult* results, size_t count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "bench_run: cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "block,bpm,steps_per_beat,density,leds,blocks,min_ns,median_ns,p99_ns,max_ns,events,events_per_sec,load_pct\n");
+    for (size_t i = 0; i < count; i++) {
+        char key[128];
+        format_key(&cases[i], key, sizeof(key));
+        fprintf(file, "%s,%u,%llu,%llu,%llu,%llu,%llu,%.1f,%.3f\n", key, results[i].blocks,
+                (unsigned long long)results[i].min_ns, (unsigned long long)results[i].median_ns,
+                (unsigned long long)results[i].p99_ns, (unsigned long long)results[i].max_ns,
+                (unsigned long long)results[i].events, results[i].events_per_sec, results[i].load);
+    }
+
+    return fclose(file) == 0;
+}
+
+// Compare median and p99 against a baseline CSV. Cases missing from the
+// baseline are skipped.
+static int compare_csv(const char* path, const BenchCase* cases, const BenchResult* results,
+                       size_t count, double tolerance) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "bench_run: cannot read baseline %s\n", path);
+        return -1;
+    }
+
+    int regressions = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        unsigned block, bpm, spb, density, blocks;
+        unsigned long long min_ns, median_ns, p99_ns;
+        char leds[16];
+
+        if (sscanf(line, "%u,%u,%u,%u,%15[^,],%u,%llu,%llu,%llu", &block, &bpm, &spb,
+                   &density, leds, &blocks, &min_ns, &median_ns, &p99_ns) != 9) {
+            continue;  // Header or malformed line
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const BenchCase* bc = &cases[i];
+            if (bc->block_size != block || bc->bpm != bpm || bc->steps_per_beat != spb ||
+                bc->density != density || strcmp(led_load_names[bc->led_load], leds) != 0) {
+                continue;
+            }
+
+            double median_limit = (double)median_ns * (1.0 + tolerance / 100.0);
+            double p99_limit = (double)p99_ns * (1.0 + tolerance / 100.0);
+            if ((double)results[i].median_ns > median_limit || (double)results[i].p99_ns > p99_limit) {
+                char key[128];
+                format_key(bc, key, sizeof(key));
+                printf("REGRESSION %s: median %llu -> %llu ns, p99 %llu -> %llu ns\n", key,
+                       median_ns, (unsigned long long)results[i].median_ns,
+                       p99_ns, (unsigned long long)results[i].p99_ns);
+                regressions++;
+            }
+            break;
+        }
+    }
+
+    fclose(file);
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    double seconds = 4.0;
+    double tolerance = 25.0;
+    const char* csv_path = NULL;
+    const char* baseline_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "qd:o:c:t:h")) != -1) {
+        switch (opt) {
+            case 'q': quick = true; break;
+            case 'd': seconds = atof(optarg); break;
+            case 'o': csv_path = optarg; break;
+            case 'c': baseline_path = optarg; break;
+            case 't': tolerance = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (seconds <= 0.0 || tolerance < 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (quick && seconds == 4.0) {
+        seconds = 1.0;
+    }
+
+    static BenchCase cases[MAX_CASES];
+    static BenchResult results[MAX_CASES];
+    size_t count = build_cases(cases, quick);
+
+    // The plugin logs to stderr from run(); keep that out of the report but
+    // inside the measurement, since the cost is real
+    fflush(stderr);
+    int saved_stderr = dup(STDERR_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    printf("%6s %4s %3s %5s %5s %10s %10s %10s %10s %10s %7s\n",
+           "block", "bpm", "spb", "cells", "leds", "min ns", "median ns", "p99 ns", "max ns",
+           "events/s", "load %");
+
+    for (size_t i = 0; i < count; i++) {
+        if (null_fd >= 0) dup2(null_fd, STDERR_FILENO);
+        bool ok = run_case(&cases[i], seconds, &results[i]);
+        fflush(stderr);
+        if (saved_stderr >= 0) dup2(saved_stderr, STDERR_FILENO);
+
+        if (!ok) {
+            fprintf(stderr, "bench_run: case %zu failed to instantiate\n", i);
+            return 1;
+        }
+
+        const BenchCase* bc = &cases[i];
+        const BenchResult* r = &results[i];
+        printf("%6u %4u %3u %5u %5s %10llu %10llu %10llu %10llu %10.1f %7.3f\n",
+               bc->block_size, bc->bpm, bc->steps_per_beat, bc->density,
+               led_load_names[bc->led_load],
+               (unsigned long long)r->min_ns, (unsigned long long)r->median_ns,
+               (unsigned long long)r->p99_ns, (unsigned long long)r->max_ns,
+               r->events_per_sec, r->load);
+        fflush(stdout);
+    }
+
+    if (null_fd >= 0) close(null_fd);
+    if (saved_stderr >= 0) close(saved_stderr);
+
+    if (csv_path && !write_csv(csv_path, cases, results, count)) {
+        return 1;
+    }
+
+    if (baseline_path) {
+        int regressions = compare_csv(baseline_path, cases, results, count, tolerance);
+        if (regressions < 0) return 1;
+        printf("%d regression(s) beyond %.1f%% against %s\n", regressions, tolerance, baseline_path);
+        if (regressions > 0) return 1;
+    }
+
+    return 0;
+}
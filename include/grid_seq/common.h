@@ -24,6 +24,9 @@
 #define MIN_SEQUENCE_LENGTH 2
 #define MAX_SEQUENCE_LENGTH 16
 #define DEFAULT_SEQUENCE_LENGTH 8
+#define DEFAULT_STEPS_PER_BEAT 1  // Grid resolution (1 step = 1 beat)
+#define MAX_STEPS_PER_BEAT 8
+#define MAX_RATCHET 4  // Hits one cell can play within its step
 
 #define PLUGIN_URI "http://github.com/danny/grid-seq"
 #define GRID_SEQ_URI PLUGIN_URI "#"
@@ -32,6 +35,83 @@
 #define GRID_SEQ__cellY GRID_SEQ_URI "cellY"
 #define GRID_SEQ__cellValue GRID_SEQ_URI "cellValue"
 
+// UI requests on midi_in: set one cell (cellX step, cellY MIDI note,
+// cellValue 0/1), ask for a gridState snapshot, apply a gridEdit, set
+// a row's loop length (cellY MIDI note, cellValue length, 0 to follow
+// the sequence length), set a cell's ratchet (cellX, cellY, cellValue
+// hits), or run a pattern generator (a generate atom holding a
+// GenRequest)
+#define GRID_SEQ__cellSet GRID_SEQ_URI "cellSet"
+#define GRID_SEQ__snapshotRequest GRID_SEQ_URI "snapshotRequest"
+#define GRID_SEQ__gridEdit GRID_SEQ_URI "gridEdit"
+#define GRID_SEQ__rowLength GRID_SEQ_URI "rowLength"
+#define GRID_SEQ__ratchet GRID_SEQ_URI "ratchet"
+#define GRID_SEQ__generate GRID_SEQ_URI "generate"
+
+// Performance counters published on the notify port
+#define GRID_SEQ__perfStats GRID_SEQ_URI "perfStats"
+#define GRID_SEQ__perfBlocks GRID_SEQ_URI "perfBlocks"
+#define GRID_SEQ__perfFrames GRID_SEQ_URI "perfFrames"
+#define GRID_SEQ__perfRunNsMean GRID_SEQ_URI "perfRunNsMean"
+#define GRID_SEQ__perfRunNsMax GRID_SEQ_URI "perfRunNsMax"
+#define GRID_SEQ__perfRunNsHist GRID_SEQ_URI "perfRunNsHist"
+#define GRID_SEQ__perfDspLoad GRID_SEQ_URI "perfDspLoad"
+#define GRID_SEQ__perfStepHist GRID_SEQ_URI "perfStepHist"
+#define GRID_SEQ__perfEvents GRID_SEQ_URI "perfEvents"
+#define GRID_SEQ__perfHighWater GRID_SEQ_URI "perfHighWater"
+#define GRID_SEQ__perfCapacity GRID_SEQ_URI "perfCapacity"
+#define GRID_SEQ__perfOverflows GRID_SEQ_URI "perfOverflows"
+#define GRID_SEQ__perfLogDropped GRID_SEQ_URI "perfLogDropped"
+
+// Body of a gridState atom on the notify port: the whole grid, one bit
+// per cell, so the UI can show any part of the pitch range, each row's
+// loop length and two bits per cell for ratchets
+#define GRID_SNAPSHOT_COLUMN_BYTES (GRID_PITCH_RANGE / 8)
+#define GRID_SNAPSHOT_RATCHET_BYTES (GRID_PITCH_RANGE / 4)
+
+typedef struct {
+    uint8_t sequence_length;
+    uint8_t pitch_offset;     // Bottom note of the Launchpad view
+    uint8_t current_step;
+    uint8_t scale;            // ScaleType the rows follow
+    uint8_t key;              // Root pitch class of the scale
+    uint8_t reserved[3];
+    uint8_t cells[MAX_GRID_SIZE][GRID_SNAPSHOT_COLUMN_BYTES];  // Note n: byte n / 8, bit n % 8
+    uint8_t row_lengths[GRID_PITCH_RANGE];  // 0 where the row follows sequence_length
+    uint8_t ratchets[MAX_GRID_SIZE][GRID_SNAPSHOT_RATCHET_BYTES];  // Note n: hits - 1 in
+                                                                   // byte n / 4, bits 2 * (n % 4)
+} GridSnapshot;
+
+// Body of a gridEdit atom on midi_in: one edit transaction from the UI,
+// however many cells it touches. Every cell with its mask bit set takes
+// its bit from cells; the plugin applies the whole edit before the block
+// is sequenced, so no step ever plays half an edit.
+typedef struct {
+    uint8_t mask[MAX_GRID_SIZE][GRID_SNAPSHOT_COLUMN_BYTES];
+    uint8_t cells[MAX_GRID_SIZE][GRID_SNAPSHOT_COLUMN_BYTES];
+} GridEdit;
+
+// Body of a generate atom on midi_in. The plugin generates in its worker
+// thread and swaps the result in at the start of the next bar; cells
+// outside the target area keep their value.
+typedef enum {
+    GEN_EUCLID = 0,   // hits spread as evenly as possible over steps
+    GEN_RANDOM = 1,   // Each cell on with probability amount %
+    GEN_MUTATE = 2    // Each cell flipped with probability amount %
+} GenAlgorithm;
+
+typedef struct {
+    uint8_t algorithm;  // GenAlgorithm
+    uint8_t note;       // Lowest row of the target area
+    uint8_t rows;       // Rows from note up
+    uint8_t step;       // First step of the target area
+    uint8_t steps;      // Steps from step on; the Euclidean cycle length
+    uint8_t hits;       // Euclidean hits
+    uint8_t rotation;   // Euclidean rotation, in steps to the right
+    uint8_t amount;     // Random density or mutation probability, 0-100
+    uint32_t seed;      // Random and mutate: same seed, same result
+} GenRequest;
+
 typedef enum {
     GS_OK = 0,
     GS_ERROR_NULL_POINTER,
@@ -229,6 +229,15 @@ typedef void (*PuglFileSelectedFunc)(PuglView* view, const char* filename);
 */
 typedef void (*PuglFocusFunc)(PuglView* view, bool enter);
 
+/**
+   A function called with every native event before pugl handles it.
+
+   @param view The view the event was received for.
+   @param event The native event (an XEvent on X11).
+   @return True if the event was consumed and pugl should ignore it.
+*/
+typedef bool (*PuglNativeEventFunc)(PuglView* view, const void* event);
+
 
 /**
    Create a new GL window.
@@ -377,6 +386,33 @@ puglGetNativeWindow(PuglView* view);
 PUGL_API PuglStatus
 puglProcessEvents(PuglView* view);
 
+/**
+   Set the function called with every native event.
+*/
+PUGL_API void
+puglSetNativeEventFunc(PuglView* view, PuglNativeEventFunc nativeEventFunc);
+
+/**
+   Set whether the GL buffers are flushed and swapped after each display.
+
+   Pass false when the display function presents to the window by other
+   means, so the GL back buffer does not overwrite it.  Defaults to true.
+*/
+PUGL_API void
+puglSetSwapBuffers(PuglView* view, bool swap);
+
+/**
+   Make the view's GL context current outside of a callback.
+*/
+PUGL_API void
+puglEnterContext(PuglView* view);
+
+/**
+   Release the GL context made current by puglEnterContext().
+*/
+PUGL_API void
+puglLeaveContext(PuglView* view);
+
 /**
    Request a redisplay on the next call to puglProcessEvents().
 */
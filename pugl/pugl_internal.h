@@ -39,6 +39,7 @@ struct PuglViewImpl {
 	PuglSpecialFunc  specialFunc;
 	PuglFocusFunc    focusFunc;
 	PuglFileSelectedFunc fileSelectedFunc;
+	PuglNativeEventFunc  nativeEventFunc;
 
 	PuglInternals* impl;
 
@@ -54,6 +55,7 @@ struct PuglViewImpl {
 	bool     set_window_hints;
 	bool     ontop;
 	bool     resize;
+	bool     no_swap;
 	float    ui_scale;
 	uint32_t event_timestamp_ms;
 };
@@ -119,6 +121,18 @@ puglSetDisplayFunc(PuglView* view, PuglDisplayFunc displayFunc)
 	view->displayFunc = displayFunc;
 }
 
+void
+puglSetNativeEventFunc(PuglView* view, PuglNativeEventFunc nativeEventFunc)
+{
+	view->nativeEventFunc = nativeEventFunc;
+}
+
+void
+puglSetSwapBuffers(PuglView* view, bool swap)
+{
+	view->no_swap = !swap;
+}
+
 void
 puglSetKeyboardFunc(PuglView* view, PuglKeyboardFunc keyboardFunc)
 {
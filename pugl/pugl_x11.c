@@ -101,6 +101,23 @@ static int attrListDblMS[] = {
 	None
 };
 
+/**
+   Backing scale from the Xft.dpi resource (96 dpi is 1.0), as set by
+   desktop environments on HiDPI screens.
+*/
+static float
+puglScaleFromResources(Display* display)
+{
+	const char* resources = XResourceManagerString(display);
+	const char* dpi = resources ? strstr(resources, "Xft.dpi:") : NULL;
+	if (!dpi) {
+		return 1.0f;
+	}
+
+	const float value = strtof(dpi + strlen("Xft.dpi:"), NULL);
+	return value > 96.0f ? value / 96.0f : 1.0f;
+}
+
 	PuglView*
 puglCreate(PuglNativeWindow parent,
            const char*      title,
@@ -135,6 +152,7 @@ puglCreate(PuglNativeWindow parent,
 		return 0;
 	}
 	impl->screen  = DefaultScreen(impl->display);
+	view->ui_scale = puglScaleFromResources(impl->display);
 	impl->doubleBuffered = True;
 
 	XVisualInfo* vi = glXChooseVisual(impl->display, impl->screen, attrListDblMS);
@@ -310,13 +328,27 @@ puglDisplay(PuglView* view)
 		view->displayFunc(view);
 	}
 
-	glFlush();
-	if (view->impl->doubleBuffered) {
-		glXSwapBuffers(view->impl->display, view->impl->win);
+	if (!view->no_swap) {
+		glFlush();
+		if (view->impl->doubleBuffered) {
+			glXSwapBuffers(view->impl->display, view->impl->win);
+		}
 	}
 	glXMakeCurrent(view->impl->display, None, NULL);
 }
 
+void
+puglEnterContext(PuglView* view)
+{
+	glXMakeCurrent(view->impl->display, view->impl->win, view->impl->ctx);
+}
+
+void
+puglLeaveContext(PuglView* view)
+{
+	glXMakeCurrent(view->impl->display, None, NULL);
+}
+
 static void
 puglResize(PuglView* view)
 {
@@ -409,6 +441,10 @@ puglProcessEvents(PuglView* view)
 	while (XPending(view->impl->display) > 0) {
 		XNextEvent(view->impl->display, &event);
 
+		if (view->nativeEventFunc && view->nativeEventFunc(view, &event)) {
+			continue;
+		}
+
 #ifdef WITH_SOFD
 		if (x_fib_handle_events(view->impl->display, &event)) {
 			const int status = x_fib_status();
@@ -0,0 +1,141 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "clock_sync.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void clock_sync_init(ClockSync* sync, double sample_rate) {
+    if (!sync) return;
+
+    memset(sync, 0, sizeof(*sync));
+    sync->sample_rate = sample_rate;
+}
+
+void clock_sync_reset(ClockSync* sync) {
+    if (!sync) return;
+
+    const double sample_rate = sync->sample_rate;
+    const uint64_t now = sync->now;
+    clock_sync_init(sync, sample_rate);
+    sync->now = now;
+}
+
+// Feed one tick's arrival time to the loop
+static void s_tick(ClockSync* sync, double time) {
+    if (!sync->have_tick) {
+        sync->have_tick = true;
+        sync->t0 = time;
+        return;
+    }
+
+    if (!sync->locked) {
+        // Two ticks give the first period
+        const double period = time - sync->t0;
+        sync->t0 = time;
+        if (period <= 0.0) return;
+
+        sync->period = period;
+        sync->t1 = time + period;
+        sync->locked = true;
+        sync->lock_ticks = 1;
+        return;
+    }
+
+    const double error = time - sync->t1;
+    if (fabs(error) > sync->period * CLOCK_SYNC_RELOCK) {
+        // The master stalled, jumped or changed tempo abruptly: lock again
+        sync->locked = false;
+        sync->t0 = time;
+        return;
+    }
+
+    const double bandwidth = sync->lock_ticks < CLOCK_SYNC_LOCK_TICKS ? CLOCK_SYNC_WIDE_HZ
+                                                                      : CLOCK_SYNC_NARROW_HZ;
+    double omega = 2.0 * M_PI * bandwidth * sync->period / sync->sample_rate;
+    if (omega > 0.5) omega = 0.5;
+
+    sync->t0 = sync->t1;
+    sync->t1 += sqrt(2.0) * omega * error + sync->period;
+    sync->period += omega * omega * error;
+    sync->lock_ticks++;
+}
+
+bool clock_sync_midi(ClockSync* sync, uint32_t frame_offset, const uint8_t* msg, uint32_t size,
+                     ClockSyncAction* action) {
+    if (!sync || !msg || !size) return false;
+
+    *action = CLOCK_SYNC_NONE;
+    switch (msg[0]) {
+    case 0xF8:  // Timing Clock
+        s_tick(sync, (double)(sync->now + frame_offset));
+        if (sync->armed) {
+            sync->armed = false;
+            sync->running = true;
+            *action = CLOCK_SYNC_START;
+        }
+        if (sync->running) sync->tick = sync->position++;
+        return true;
+    case 0xFA:  // Start: from the top at the next tick
+        sync->position = 0;
+        sync->armed = true;
+        return true;
+    case 0xFB:  // Continue: from the song position at the next tick
+        sync->armed = !sync->running;
+        return true;
+    case 0xFC:  // Stop: the position is kept for Continue
+        if (sync->running) *action = CLOCK_SYNC_STOP;
+        sync->running = false;
+        sync->armed = false;
+        return true;
+    case 0xF2:  // Song Position Pointer, in sixteenths (6 ticks)
+        if (size < 3) return true;
+        if (!sync->running) {
+            sync->position = (uint64_t)((msg[1] & 0x7F) | ((msg[2] & 0x7F) << 7)) * 6;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+double clock_sync_bpm(const ClockSync* sync) {
+    if (!sync || !sync->locked || sync->period <= 0.0) return 0.0;
+    return 60.0 * sync->sample_rate / (sync->period * CLOCK_SYNC_PPQN);
+}
+
+uint64_t clock_sync_target(const ClockSync* sync, uint32_t frame_offset, uint64_t frames_per_beat) {
+    if (!sync) return 0;
+
+    const uint64_t here = clock_sync_tick_frame(sync->tick, frames_per_beat);
+    const uint64_t next = clock_sync_tick_frame(sync->tick + 1, frames_per_beat);
+    if (next <= here + 1) return here;
+
+    // Before the loop has locked the sequencer's own tempo stands in
+    const double period = sync->locked ? sync->period : (double)frames_per_beat / CLOCK_SYNC_PPQN;
+    const double elapsed = (double)(sync->now + frame_offset) - sync->t0;
+    if (elapsed <= 0.0 || period <= 0.0) return here;
+
+    const double ahead = elapsed / period * (double)(next - here);
+    return ahead < (double)(next - here - 1) ? here + (uint64_t)ahead : next - 1;
+}
+
+void clock_sync_advance(ClockSync* sync, uint32_t n_samples) {
+    if (!sync) return;
+    sync->now += n_samples;
+}
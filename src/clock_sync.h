@@ -0,0 +1,114 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_CLOCK_SYNC_H
+#define GRID_SEQ_CLOCK_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// MIDI clock slave: follow a hardware master's 24 PPQN clock and its
+// Start, Stop, Continue and Song Position messages instead of the host
+// transport.
+//
+// Tick arrival times are filtered by a second-order delay-locked loop,
+// which yields both the tick period (the tempo) and a smoothed time for
+// every tick. The sequencer's position is taken from the tick count,
+// interpolated between filtered tick times, so steps fall on the master's
+// ticks and estimator noise can move a step by a few frames at most,
+// never by a step. The loop starts wide, to lock within a beat, and then
+// narrows to reject USB-MIDI timing jitter.
+
+#define CLOCK_SYNC_PPQN 24
+#define CLOCK_SYNC_WIDE_HZ 2.0     // Loop bandwidth while locking
+#define CLOCK_SYNC_NARROW_HZ 0.5   // Loop bandwidth once locked
+#define CLOCK_SYNC_LOCK_TICKS 24   // Ticks at the wide bandwidth
+#define CLOCK_SYNC_RELOCK 0.5      // Error (in periods) that restarts the lock
+// The sequencer runs this much faster than the tracked tempo, so it never
+// falls behind the master: it reaches each tick a little early and holds
+// there until the tick arrives
+#define CLOCK_SYNC_LEAD 0.001
+
+typedef enum {
+    CLOCK_SYNC_NONE = 0,
+    CLOCK_SYNC_START,  // The transport starts at this tick (Start or Continue)
+    CLOCK_SYNC_STOP
+} ClockSyncAction;
+
+typedef struct {
+    double sample_rate;
+    uint64_t now;        // Frame of the current block's first sample
+
+    // Delay-locked loop, times in frames
+    bool have_tick;      // t0 holds the last tick's arrival time
+    bool locked;         // period holds a measured tick period
+    uint32_t lock_ticks; // Ticks since the loop (re)locked
+    double t0;           // Filtered time of the last tick
+    double t1;           // Predicted time of the next tick
+    double period;       // Filtered tick period
+
+    // Master transport
+    bool running;
+    bool armed;          // Start or Continue received, waiting for a tick
+    uint64_t tick;       // Song position of the last tick, in ticks
+    uint64_t position;   // Song position the next tick plays
+} ClockSync;
+
+/**
+ * Initialize an unlocked, stopped follower.
+ */
+void clock_sync_init(ClockSync* sync, double sample_rate);
+
+/**
+ * Forget the tempo and the transport, e.g. when slave mode is switched on.
+ */
+void clock_sync_reset(ClockSync* sync);
+
+/**
+ * Take a MIDI message from the current block. Real-time safe.
+ *
+ * @param frame_offset Frame of the message within the block
+ * @param action Set to what the sequencer's transport has to do
+ * @return true for clock and transport messages (they are consumed)
+ */
+bool clock_sync_midi(ClockSync* sync, uint32_t frame_offset, const uint8_t* msg, uint32_t size,
+                     ClockSyncAction* action);
+
+/**
+ * Tracked tempo in beats per minute, 0 until the loop has locked.
+ */
+double clock_sync_bpm(const ClockSync* sync);
+
+/**
+ * Where the sequencer should stand at a frame of the current block, on
+ * its own clock: the last tick's frame plus the time since its filtered
+ * arrival, held just short of the next tick until that tick arrives.
+ *
+ * @param frame_offset Frame within the block (n_samples for its end)
+ * @param frames_per_beat Sequencer frames per beat
+ */
+uint64_t clock_sync_target(const ClockSync* sync, uint32_t frame_offset, uint64_t frames_per_beat);
+
+/**
+ * Sequencer frame a song position (in ticks) starts on.
+ */
+static inline uint64_t clock_sync_tick_frame(uint64_t tick, uint64_t frames_per_beat) {
+    return tick * frames_per_beat / CLOCK_SYNC_PPQN;
+}
+
+/**
+ * Move on to the next block.
+ */
+void clock_sync_advance(ClockSync* sync, uint32_t n_samples);
+
+#endif // GRID_SEQ_CLOCK_SYNC_H
@@ -0,0 +1,107 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "controls.h"
+#include "launchpad.h"
+
+#include <string.h>
+
+void controls_init(ControlMap* map) {
+    if (!map) return;
+
+    memset(map, 0, sizeof(*map));
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 91, CONTROL_PITCH_DOWN, 1);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 92, CONTROL_PITCH_UP, 1);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 93, CONTROL_PAGE_PREV, 0);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 94, CONTROL_PAGE_NEXT, 0);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 95, CONTROL_PITCH_DOWN, 12);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 96, CONTROL_PITCH_UP, 12);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 97, CONTROL_SHIFT, 0);
+    controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, 98, CONTROL_FILL, 0);
+    controls_bind(map, CONTROL_LAYER_SHIFTED, CONTROL_MSG_CC, 98, CONTROL_LENGTH_CYCLE, 0);
+
+    // Scene buttons are listed top to bottom
+    for (uint8_t i = 0; i < 8; i++) {
+        const uint8_t row = (uint8_t)(7 - i);
+        controls_bind(map, CONTROL_LAYER_NORMAL, CONTROL_MSG_CC, LP_SCENE_CCS[i], CONTROL_MUTE_ROW, row);
+        controls_bind(map, CONTROL_LAYER_SHIFTED, CONTROL_MSG_CC, LP_SCENE_CCS[i], CONTROL_GENERATE, row);
+    }
+}
+
+void controls_bind(ControlMap* map, ControlLayer layer, ControlMsgType type, uint8_t number,
+                   ControlAction action, uint8_t param) {
+    if (!map || layer >= CONTROL_LAYERS || type >= CONTROL_MSG_TYPES || action >= CONTROL_ACTION_COUNT) {
+        return;
+    }
+
+    map->table[layer][type][number].action = (uint8_t)action;
+    map->table[layer][type][number].param = param;
+}
+
+bool controls_apply(GridSeqState* state, const ControlBinding* binding, bool pressed,
+                    const ControlSurface* surface) {
+    if (!state || !binding || !surface) return false;
+
+    // Momentary actions follow the button; all others act on press only
+    if (binding->action == CONTROL_FILL || binding->action == CONTROL_SHIFT) {
+        bool* held = binding->action == CONTROL_FILL ? &state->fill : &state->shift;
+        bool changed = *held != pressed;
+        *held = pressed;
+        return changed;
+    }
+    if (!pressed) return false;
+
+    const uint8_t max_offset = (uint8_t)(GRID_PITCH_RANGE - surface->rows);
+
+    switch (binding->action) {
+    case CONTROL_PAGE_PREV:
+        if (!surface->paging || state->hardware_page == 0) return false;
+        state->hardware_page = 0;
+        return true;
+
+    case CONTROL_PAGE_NEXT:
+        // Page 1 only exists for sequences longer than 8 steps
+        if (!surface->paging || state->hardware_page == 1 || state->sequence_length <= 8) {
+            return false;
+        }
+        state->hardware_page = 1;
+        return true;
+
+    case CONTROL_PITCH_DOWN:
+        if (state->pitch_offset == 0) return false;
+        state->pitch_offset = state->pitch_offset > binding->param
+                                  ? (uint8_t)(state->pitch_offset - binding->param) : 0;
+        return true;
+
+    case CONTROL_PITCH_UP:
+        if (state->pitch_offset >= max_offset) return false;
+        state->pitch_offset = state->pitch_offset + binding->param < max_offset
+                                  ? (uint8_t)(state->pitch_offset + binding->param) : max_offset;
+        return true;
+
+    case CONTROL_MUTE_ROW: {
+        uint32_t note = (uint32_t)state->pitch_offset + surface->row + binding->param;
+        if (note >= GRID_PITCH_RANGE) return false;
+        state->muted[note] = !state->muted[note];
+        return true;
+    }
+
+    case CONTROL_LENGTH_CYCLE:
+        state->sequence_length = state->sequence_length >= MAX_SEQUENCE_LENGTH
+                                     ? 4 : (uint8_t)((state->sequence_length / 4 + 1) * 4);
+        if (state->sequence_length <= 8) state->hardware_page = 0;
+        return true;
+
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_CONTROLS_H
+#define GRID_SEQ_CONTROLS_H
+
+#include "state.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Control surface mapping.
+//
+// Buttons and MIDI messages are bound to performance actions through one
+// lookup table per message type, indexed directly by the note or CC
+// number. The tables have 256 entries so any data byte, even a malformed
+// one, is a valid index: dispatch is a single load, with no branch chain
+// over button numbers.
+
+typedef enum {
+    CONTROL_NONE = 0,
+    CONTROL_PAGE_PREV,     // Show steps 0-7 (single Launchpad only)
+    CONTROL_PAGE_NEXT,     // Show steps 8-15 (single Launchpad only)
+    CONTROL_PITCH_DOWN,    // Shift the view down by param semitones
+    CONTROL_PITCH_UP,      // Shift the view up by param semitones
+    CONTROL_MUTE_ROW,      // Toggle mute of visible row param
+    CONTROL_LENGTH_CYCLE,  // Sequence length 4, 8, 12, 16, 4, ...
+    CONTROL_FILL,          // Momentary: every used row plays on every step
+    CONTROL_SHIFT,         // Momentary: the shifted layer applies, nothing else changes
+    CONTROL_GENERATE,      // One more Euclidean hit on visible row param (plugin only)
+    CONTROL_ACTION_COUNT
+} ControlAction;
+
+typedef struct {
+    uint8_t action;   // ControlAction
+    uint8_t param;
+} ControlBinding;
+
+typedef enum {
+    CONTROL_MSG_NOTE = 0,  // Note On / Note Off
+    CONTROL_MSG_CC = 1,    // Control Change
+    CONTROL_MSG_TYPES
+} ControlMsgType;
+
+// Bindings in the shifted layer apply while Shift is held, and fall back
+// to the normal layer where they are unbound
+typedef enum {
+    CONTROL_LAYER_NORMAL = 0,
+    CONTROL_LAYER_SHIFTED = 1,
+    CONTROL_LAYERS
+} ControlLayer;
+
+typedef struct {
+    ControlBinding table[CONTROL_LAYERS][CONTROL_MSG_TYPES][256];
+} ControlMap;
+
+// Where the device that sent a message sits on the editing surface
+typedef struct {
+    uint8_t row;       // Surface row of the device's bottom pad row
+    uint8_t rows;      // Rows the whole surface shows
+    bool paging;       // Page buttons apply (single device)
+} ControlSurface;
+
+/**
+ * Install the default Launchpad Mini Mk3 bindings:
+ * CC 91/92 pitch down/up, CC 93/94 page left/right, CC 95/96 octave
+ * down/up, CC 97 shift, CC 98 fill, scene buttons mute their row. With
+ * Shift held, CC 98 cycles the length and a scene button adds a
+ * Euclidean hit to its row.
+ */
+void controls_init(ControlMap* map);
+
+/**
+ * Bind a note or CC number to an action (CONTROL_NONE removes it).
+ */
+void controls_bind(ControlMap* map, ControlLayer layer, ControlMsgType type, uint8_t number,
+                   ControlAction action, uint8_t param);
+
+/**
+ * Find the binding for a MIDI message. Only channel 1 is looked up: the
+ * Launchpad sends its pads and buttons there, and the same numbers on
+ * other channels belong to keyboards and other gear.
+ *
+ * @param shifted Shift is held: look in the shifted layer first. Releases
+ *        go to the normal layer, so a button held before Shift still ends
+ * @param pressed Set to true for a press (Note On or CC value > 0)
+ * @return Binding, or NULL when the message is not bound
+ */
+static inline const ControlBinding* controls_lookup(const ControlMap* map, const uint8_t* msg,
+                                                    uint32_t size, bool shifted, bool* pressed) {
+    if (size < 3) return NULL;
+
+    int type;
+    switch (msg[0]) {
+    case 0x80: type = CONTROL_MSG_NOTE; *pressed = false; break;
+    case 0x90: type = CONTROL_MSG_NOTE; *pressed = msg[2] > 0; break;
+    case 0xB0: type = CONTROL_MSG_CC; *pressed = msg[2] > 0; break;
+    default: return NULL;
+    }
+
+    const ControlBinding* normal = &map->table[CONTROL_LAYER_NORMAL][type][msg[1]];
+    const ControlBinding* binding = &map->table[CONTROL_LAYER_SHIFTED][type][msg[1]];
+    if (!shifted || binding->action == CONTROL_NONE ||
+        (!*pressed && normal->action != CONTROL_NONE)) {
+        binding = normal;
+    }
+    return binding->action != CONTROL_NONE ? binding : NULL;
+}
+
+/**
+ * Apply a bound action to the sequencer state. Real-time safe.
+ * CONTROL_GENERATE needs the plugin's worker and is left to the caller.
+ *
+ * @param binding Binding from controls_lookup()
+ * @param pressed Press or release; only momentary actions act on release
+ * @param surface The surface the message came from
+ * @return true if the state changed
+ */
+bool controls_apply(GridSeqState* state, const ControlBinding* binding, bool pressed,
+                    const ControlSurface* surface);
+
+#endif // GRID_SEQ_CONTROLS_H
@@ -0,0 +1,88 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "follow.h"
+
+#include <string.h>
+
+void follow_init(KeyFollow* follow) {
+    if (!follow) return;
+
+    memset(follow, 0, sizeof(*follow));
+    follow->mode = FOLLOW_OFF;
+    follow->channel = FOLLOW_DEFAULT_CHANNEL;
+    follow->dirty = true;
+}
+
+void follow_configure(KeyFollow* follow, uint8_t mode, uint8_t channel) {
+    if (!follow) return;
+
+    memset(follow->held, 0, sizeof(follow->held));
+    follow->held_count = 0;
+    follow->transpose = 0;
+    follow->chord = 0;
+    follow->mode = mode;
+    follow->channel = channel & 0x0F;
+    follow->dirty = true;
+}
+
+bool follow_midi(KeyFollow* follow, const uint8_t* msg, uint32_t size) {
+    if (!follow || !msg || size < 3 || follow->mode == FOLLOW_OFF) return false;
+    if ((msg[0] & 0x0F) != follow->channel) return false;
+
+    const uint8_t type = msg[0] & 0xF0;
+    if (type != 0x90 && type != 0x80) return false;
+
+    const uint8_t note = msg[1] & 0x7F;
+    const bool on = type == 0x90 && msg[2] > 0;
+
+    if (on && !follow->held[note]) {
+        // A new chord starts when a key goes down with none held
+        if (follow->held_count == 0) follow->chord = 0;
+        follow->held[note] = true;
+        follow->held_count++;
+        follow->transpose = (int8_t)(note - FOLLOW_TRANSPOSE_ROOT);
+        follow->chord |= (uint16_t)(1u << (note % 12));
+        follow->dirty = true;
+    } else if (!on && follow->held[note]) {
+        follow->held[note] = false;
+        follow->held_count--;
+    }
+    return true;
+}
+
+// Smallest move from a pitch class to one in the chord, down first on a tie
+static int s_nearest_in_chord(uint16_t chord, int pitch_class) {
+    for (int distance = 0; distance <= 6; distance++) {
+        if (chord & (1u << ((pitch_class - distance + 12) % 12))) return -distance;
+        if (chord & (1u << ((pitch_class + distance) % 12))) return distance;
+    }
+    return 0;
+}
+
+void follow_build_offsets(KeyFollow* follow, GridSeqState* state) {
+    if (!follow || !state) return;
+
+    for (uint32_t row = 0; row < GRID_PITCH_RANGE; row++) {
+        const uint8_t note = state->row_note[row];
+        int8_t offset = 0;
+
+        if (follow->mode == FOLLOW_TRANSPOSE) {
+            offset = follow->transpose;
+        } else if (follow->mode == FOLLOW_CHORD && follow->chord && note != SCALE_NO_NOTE) {
+            offset = (int8_t)s_nearest_in_chord(follow->chord, note % 12);
+        }
+        state->row_offset[row] = offset;
+    }
+    follow->dirty = false;
+}
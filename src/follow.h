@@ -0,0 +1,72 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_FOLLOW_H
+#define GRID_SEQ_FOLLOW_H
+
+#include "state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Keyboard follow: notes played on midi_in on one channel transpose the
+// pattern, or re-voice it to the held chord, as it plays.
+//
+// The grid is never rewritten. The held keys become a per-row offset
+// table (GridSeqState.row_offset) that the sequencer adds to each row's
+// note when it sends it. The last transposition or chord is latched when
+// the keys are released.
+
+#define FOLLOW_TRANSPOSE_ROOT 60  // C3 plays the pattern untransposed
+#define FOLLOW_DEFAULT_CHANNEL 1  // Zero-based: MIDI channel 2
+
+typedef enum {
+    FOLLOW_OFF = 0,
+    FOLLOW_TRANSPOSE = 1,  // Last key pressed, relative to C3
+    FOLLOW_CHORD = 2       // Each row moves to the nearest held pitch class
+} FollowMode;
+
+typedef struct {
+    uint8_t mode;           // FollowMode
+    uint8_t channel;        // Zero-based MIDI channel keys arrive on
+    bool held[128];
+    uint8_t held_count;
+    int8_t transpose;       // Latched transposition in semitones
+    uint16_t chord;         // Latched pitch classes, bit n for class n
+    bool dirty;             // Offsets need rebuilding
+} KeyFollow;
+
+/**
+ * Initialize with follow off on FOLLOW_DEFAULT_CHANNEL.
+ */
+void follow_init(KeyFollow* follow);
+
+/**
+ * Change the mode or channel. Held keys are forgotten and the offsets
+ * rebuilt, so turning follow off plays the pattern as written again.
+ */
+void follow_configure(KeyFollow* follow, uint8_t mode, uint8_t channel);
+
+/**
+ * Take a MIDI message from midi_in. Real-time safe.
+ *
+ * @return true if it was a note on the follow channel (and is consumed)
+ */
+bool follow_midi(KeyFollow* follow, const uint8_t* msg, uint32_t size);
+
+/**
+ * Write the offset for every row into state->row_offset, for the scale the
+ * state plays in, and clear dirty.
+ */
+void follow_build_offsets(KeyFollow* follow, GridSeqState* state);
+
+#endif // GRID_SEQ_FOLLOW_H
@@ -0,0 +1,144 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "generator.h"
+
+#include <string.h>
+
+static bool s_get(const GenPattern* pattern, uint8_t step, uint8_t note) {
+    return (pattern->cells[step][note / 8] >> (note % 8)) & 1;
+}
+
+static void s_set(GenPattern* pattern, uint8_t step, uint8_t note, bool value) {
+    const uint8_t bit = (uint8_t)(1u << (note % 8));
+    if (value) {
+        pattern->cells[step][note / 8] |= bit;
+    } else {
+        pattern->cells[step][note / 8] &= (uint8_t)~bit;
+    }
+}
+
+bool generator_cell(const GenPattern* pattern, uint8_t step, uint8_t note) {
+    return s_get(pattern, step, note);
+}
+
+// xorshift32: small, fast and the same on every platform
+static uint32_t s_next(uint32_t* rng) {
+    uint32_t x = *rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *rng = x;
+}
+
+static bool s_chance(uint32_t* rng, uint8_t percent) {
+    return s_next(rng) % 100 < percent;
+}
+
+void generator_capture(const GridSeqState* state, GenPattern* pattern) {
+    if (!state || !pattern) return;
+
+    memset(pattern, 0, sizeof(*pattern));
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            if (state->grid[x][note]) s_set(pattern, x, note, true);
+        }
+    }
+}
+
+uint32_t generator_apply(GridSeqState* state, const GenPattern* pattern, const GenPattern* mask) {
+    if (!state || !pattern || !mask) return 0;
+
+    uint32_t changed = 0;
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            if (!s_get(mask, x, note)) continue;
+
+            const bool value = s_get(pattern, x, note);
+            if (state->grid[x][note] != value) {
+                state->grid[x][note] = value;
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+void generator_overlay(GenPattern* into, const GenPattern* from, const GenPattern* mask) {
+    if (!into || !from || !mask) return;
+
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t byte = 0; byte < GRID_SNAPSHOT_COLUMN_BYTES; byte++) {
+            into->cells[x][byte] = (uint8_t)((into->cells[x][byte] & ~mask->cells[x][byte]) |
+                                             (from->cells[x][byte] & mask->cells[x][byte]));
+        }
+    }
+}
+
+void generator_mark(GenPattern* mask, const GenRequest* area) {
+    if (!mask || !area) return;
+
+    for (uint32_t x = area->step; x < (uint32_t)area->step + area->steps && x < MAX_GRID_SIZE; x++) {
+        for (uint32_t note = area->note; note < (uint32_t)area->note + area->rows && note < GRID_PITCH_RANGE; note++) {
+            s_set(mask, (uint8_t)x, (uint8_t)note, true);
+        }
+    }
+}
+
+// Bresenham form of Bjorklund's algorithm: step i is a hit when the
+// running total i * hits wraps past a multiple of steps
+bool generator_euclid_hit(uint8_t hits, uint8_t steps, uint8_t rotation, uint8_t i) {
+    if (!steps || !hits) return false;
+    if (hits >= steps) return true;
+
+    const uint32_t j = ((uint32_t)i + steps - rotation % steps) % steps;
+    return (j * hits) % steps < hits;
+}
+
+bool generator_run(const GenRequest* request, GenPattern* pattern) {
+    if (!request || !pattern) return false;
+    if (request->note >= GRID_PITCH_RANGE || request->rows == 0 ||
+        request->note + request->rows > GRID_PITCH_RANGE ||
+        request->step >= MAX_GRID_SIZE || request->steps == 0 ||
+        request->step + request->steps > MAX_GRID_SIZE || request->algorithm > GEN_MUTATE) {
+        return false;
+    }
+
+    // A zero seed would keep xorshift at zero
+    uint32_t rng = request->seed ? request->seed : 0x9E3779B9u;
+
+    for (uint8_t row = 0; row < request->rows; row++) {
+        const uint8_t note = (uint8_t)(request->note + row);
+
+        for (uint8_t i = 0; i < request->steps; i++) {
+            const uint8_t step = (uint8_t)(request->step + i);
+
+            switch (request->algorithm) {
+            case GEN_EUCLID:
+                s_set(pattern, step, note,
+                      generator_euclid_hit(request->hits, request->steps, request->rotation, i));
+                break;
+            case GEN_RANDOM:
+                s_set(pattern, step, note, s_chance(&rng, request->amount));
+                break;
+            case GEN_MUTATE:
+                if (s_chance(&rng, request->amount)) {
+                    s_set(pattern, step, note, !s_get(pattern, step, note));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_GENERATOR_H
+#define GRID_SEQ_GENERATOR_H
+
+#include "grid_seq/common.h"
+#include "state.h"
+
+// Pattern generators: Euclidean rhythms, random fills and mutation.
+//
+// Generators work on a whole pattern, one bit per cell like a snapshot,
+// so a pattern can be handed between threads by value. The plugin packs
+// its grid on the audio thread, generates in the worker, and applies the
+// result on the audio thread at a bar boundary.
+
+typedef struct {
+    uint8_t cells[MAX_GRID_SIZE][GRID_SNAPSHOT_COLUMN_BYTES];  // Note n: byte n / 8, bit n % 8
+} GenPattern;
+
+/**
+ * Whether a pattern has a cell set. Real-time safe.
+ */
+bool generator_cell(const GenPattern* pattern, uint8_t step, uint8_t note);
+
+/**
+ * Pack a state's grid into a pattern. Real-time safe.
+ */
+void generator_capture(const GridSeqState* state, GenPattern* pattern);
+
+/**
+ * Copy the cells set in mask from a pattern into a state's grid, leaving
+ * edits made elsewhere meanwhile alone. Real-time safe.
+ *
+ * @return Number of cells that changed
+ */
+uint32_t generator_apply(GridSeqState* state, const GenPattern* pattern, const GenPattern* mask);
+
+/**
+ * Copy the cells set in mask from one pattern into another.
+ */
+void generator_overlay(GenPattern* into, const GenPattern* from, const GenPattern* mask);
+
+/**
+ * Set the cells of a request's target area in a mask.
+ */
+void generator_mark(GenPattern* mask, const GenRequest* area);
+
+/**
+ * Regenerate the request's target area of a pattern; the rest is kept.
+ * Deterministic for a given request and pattern.
+ *
+ * @return false if the request is out of range (pattern untouched)
+ */
+bool generator_run(const GenRequest* request, GenPattern* pattern);
+
+/**
+ * Whether step i of a Euclidean rhythm of hits over steps is a hit.
+ */
+bool generator_euclid_hit(uint8_t hits, uint8_t steps, uint8_t rotation, uint8_t i);
+
+#endif // GRID_SEQ_GENERATOR_H
@@ -0,0 +1,304 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "gl_canvas.h"
+#include "x11_backbuffer.h"
+
+#include <GL/gl.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define CANVAS_MAX_RECTS 8
+
+typedef struct {
+    int x, y, width, height;
+} DamageRect;
+
+struct GlCanvas {
+    cairo_surface_t* surface;
+    int width;              // Pixels
+    int height;
+    double scale;           // Pixels per logical unit
+
+    GLuint texture;         // 0 until first presented
+    int texture_width;
+    int texture_height;
+
+    DamageRect damage[CANVAS_MAX_RECTS];  // Pixels
+    int num_damage;
+    bool drawn;             // Damage drawn and waiting for upload
+
+    // Back buffer presenter, recreated on resize
+    X11Backbuffer* backbuffer;  // NULL: present through GL
+    Display* display;
+    Window window;
+    Visual* visual;
+    int depth;
+    bool exposed;           // Displayed while busy: send the whole image next
+};
+
+GlCanvas* canvas_create(void) {
+    GlCanvas* canvas = (GlCanvas*)calloc(1, sizeof(GlCanvas));
+    if (canvas) canvas->scale = 1.0;
+    return canvas;
+}
+
+void canvas_destroy(GlCanvas* canvas) {
+    if (!canvas) return;
+
+    if (canvas->texture) {
+        glDeleteTextures(1, &canvas->texture);
+    }
+    // The surface draws into the back buffer's image: release it first
+    if (canvas->surface) {
+        cairo_surface_destroy(canvas->surface);
+    }
+    backbuffer_destroy(canvas->backbuffer);
+    free(canvas);
+}
+
+// Swap in a new surface (and back buffer) and damage all of it
+static void s_set_surface(GlCanvas* canvas, cairo_surface_t* surface, X11Backbuffer* backbuffer,
+                          int width, int height, double scale) {
+    if (canvas->surface) {
+        cairo_surface_destroy(canvas->surface);
+    }
+    if (backbuffer) {
+        backbuffer_destroy(canvas->backbuffer);
+        canvas->backbuffer = backbuffer;
+    }
+    canvas->surface = surface;
+    canvas->width = width;
+    canvas->height = height;
+    canvas->scale = scale;
+
+    canvas->num_damage = 0;
+    canvas->drawn = false;
+    canvas_damage(canvas, 0, 0, width / scale, height / scale);
+}
+
+bool canvas_resize(GlCanvas* canvas, int width, int height, double scale) {
+    if (!canvas || width <= 0 || height <= 0 || scale <= 0.0) return false;
+
+    if (canvas->surface && width == canvas->width && height == canvas->height &&
+        scale == canvas->scale) {
+        return true;
+    }
+
+    if (canvas->backbuffer) {
+        X11Backbuffer* backbuffer = backbuffer_create(canvas->display, canvas->window,
+                                                      canvas->visual, canvas->depth, width, height);
+        if (!backbuffer) return false;
+
+        s_set_surface(canvas, cairo_surface_reference(backbuffer_surface(backbuffer)), backbuffer,
+                      width, height, scale);
+        return true;
+    }
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return false;
+    }
+
+    s_set_surface(canvas, surface, NULL, width, height, scale);
+    return true;
+}
+
+bool canvas_use_backbuffer(GlCanvas* canvas, Display* display, Window window, Visual* visual,
+                           int depth) {
+    if (!canvas || !canvas->surface || canvas->backbuffer) return false;
+
+    X11Backbuffer* backbuffer = backbuffer_create(display, window, visual, depth,
+                                                  canvas->width, canvas->height);
+    if (!backbuffer) return false;
+
+    canvas->display = display;
+    canvas->window = window;
+    canvas->visual = visual;
+    canvas->depth = depth;
+    s_set_surface(canvas, cairo_surface_reference(backbuffer_surface(backbuffer)), backbuffer,
+                  canvas->width, canvas->height, canvas->scale);
+    return true;
+}
+
+bool canvas_handle_event(GlCanvas* canvas, const XEvent* event, bool* redraw) {
+    if (!canvas || !backbuffer_handle_event(canvas->backbuffer, event)) return false;
+
+    *redraw = canvas->exposed || canvas->num_damage > 0;
+    return true;
+}
+
+static bool s_overlaps(const DamageRect* a, const DamageRect* b) {
+    return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+           a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static void s_merge(DamageRect* into, const DamageRect* rect) {
+    int x1 = into->x + into->width > rect->x + rect->width ? into->x + into->width : rect->x + rect->width;
+    int y1 = into->y + into->height > rect->y + rect->height ? into->y + into->height : rect->y + rect->height;
+    into->x = into->x < rect->x ? into->x : rect->x;
+    into->y = into->y < rect->y ? into->y : rect->y;
+    into->width = x1 - into->x;
+    into->height = y1 - into->y;
+}
+
+void canvas_damage(GlCanvas* canvas, double x, double y, double width, double height) {
+    if (!canvas || !canvas->surface) return;
+
+    // To whole pixels, rounding outwards
+    int x0 = (int)floor(x * canvas->scale);
+    int y0 = (int)floor(y * canvas->scale);
+    int x1 = (int)ceil((x + width) * canvas->scale);
+    int y1 = (int)ceil((y + height) * canvas->scale);
+
+    // Clip to the surface
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width) x1 = canvas->width;
+    if (y1 > canvas->height) y1 = canvas->height;
+    if (x1 <= x0 || y1 <= y0) return;
+
+    DamageRect rect = {x0, y0, x1 - x0, y1 - y0};
+    for (int i = 0; i < canvas->num_damage; i++) {
+        if (s_overlaps(&canvas->damage[i], &rect)) {
+            s_merge(&canvas->damage[i], &rect);
+            return;
+        }
+    }
+
+    if (canvas->num_damage == CANVAS_MAX_RECTS) {
+        s_merge(&canvas->damage[0], &rect);
+        return;
+    }
+    canvas->damage[canvas->num_damage++] = rect;
+}
+
+cairo_t* canvas_begin(GlCanvas* canvas) {
+    if (!canvas || !canvas->surface || canvas->num_damage == 0) return NULL;
+
+    // The server is still reading the image: keep the damage for later
+    if (canvas->backbuffer && !backbuffer_ready(canvas->backbuffer)) return NULL;
+
+    cairo_t* cr = cairo_create(canvas->surface);
+    for (int i = 0; i < canvas->num_damage; i++) {
+        const DamageRect* r = &canvas->damage[i];
+        cairo_rectangle(cr, r->x, r->y, r->width, r->height);
+    }
+    cairo_clip(cr);
+    cairo_scale(cr, canvas->scale, canvas->scale);
+    return cr;
+}
+
+void canvas_end(GlCanvas* canvas, cairo_t* cr) {
+    if (!canvas || !cr) return;
+
+    cairo_destroy(cr);
+    cairo_surface_flush(canvas->surface);
+    canvas->drawn = true;
+}
+
+static void s_upload(GlCanvas* canvas) {
+    const unsigned char* data = cairo_image_surface_get_data(canvas->surface);
+    const int stride = cairo_image_surface_get_stride(canvas->surface);
+
+    // Cairo's ARGB32 is BGRA in memory on little-endian hosts
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 4);
+
+    if (canvas->texture_width != canvas->width || canvas->texture_height != canvas->height) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, canvas->width, canvas->height, 0,
+                     GL_BGRA, GL_UNSIGNED_BYTE, data);
+        canvas->texture_width = canvas->width;
+        canvas->texture_height = canvas->height;
+    } else {
+        for (int i = 0; i < canvas->num_damage; i++) {
+            const DamageRect* r = &canvas->damage[i];
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, r->x);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, r->y);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, r->x, r->y, r->width, r->height,
+                            GL_BGRA, GL_UNSIGNED_BYTE, data);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+}
+
+// Send the drawn rectangles through the back buffer; with nothing drawn
+// this is an Expose, and the window needs the whole image again
+static void s_present_backbuffer(GlCanvas* canvas) {
+    if (!backbuffer_ready(canvas->backbuffer)) {
+        canvas->exposed = true;
+        return;
+    }
+
+    if (canvas->drawn && !canvas->exposed) {
+        for (int i = 0; i < canvas->num_damage; i++) {
+            const DamageRect* r = &canvas->damage[i];
+            backbuffer_damage(canvas->backbuffer, r->x, r->y, r->width, r->height);
+        }
+    } else {
+        backbuffer_damage(canvas->backbuffer, 0, 0, canvas->width, canvas->height);
+    }
+    if (canvas->drawn) {
+        canvas->num_damage = 0;
+        canvas->drawn = false;
+    }
+    canvas->exposed = false;
+    backbuffer_present(canvas->backbuffer);
+}
+
+void canvas_present(GlCanvas* canvas) {
+    if (!canvas || !canvas->surface) return;
+
+    if (canvas->backbuffer) {
+        s_present_backbuffer(canvas);
+        return;
+    }
+
+    if (!canvas->texture) {
+        glGenTextures(1, &canvas->texture);
+        glBindTexture(GL_TEXTURE_2D, canvas->texture);
+        // One texel per pixel: no filtering needed
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, canvas->texture);
+    }
+
+    if (canvas->drawn) {
+        s_upload(canvas);
+        canvas->num_damage = 0;
+        canvas->drawn = false;
+    }
+
+    glViewport(0, 0, canvas->width, canvas->height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, 1.0, 1.0, 0.0, -1.0, 1.0);  // Top-left origin, like the image
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, 0.0f);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, 1.0f);
+    glEnd();
+    glDisable(GL_TEXTURE_2D);
+}
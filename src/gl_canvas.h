@@ -0,0 +1,98 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_GL_CANVAS_H
+#define GRID_SEQ_GL_CANVAS_H
+
+#include <X11/Xlib.h>
+#include <cairo/cairo.h>
+#include <stdbool.h>
+
+// Cairo drawing surface shown through an OpenGL texture.
+//
+// The UI draws with Cairo into an image surface at the window's pixel
+// size, in logical (unscaled) coordinates: the canvas applies the HiDPI
+// scale. Only damaged areas are rasterised, and only those areas are
+// uploaded to the texture. Every frame then draws the whole texture as one
+// quad, so an Expose or a buffer swap never costs a Cairo redraw.
+//
+// A frame is canvas_begin(), drawing, canvas_end(), then canvas_present()
+// with the GL context current (inside the pugl display callback).
+//
+// With an indirect GLX context every texture upload is GLX protocol, so
+// the canvas can present through an MIT-SHM back buffer instead
+// (canvas_use_backbuffer()): Cairo then draws into the shared image and
+// the damaged rectangles go to the window with XShmPutImage, bypassing GL.
+
+typedef struct GlCanvas GlCanvas;
+
+GlCanvas* canvas_create(void);
+
+/**
+ * Free the canvas. Call with the GL context current, so the texture can
+ * be deleted, and before the window's display connection is closed.
+ */
+void canvas_destroy(GlCanvas* canvas);
+
+/**
+ * Set the pixel size and the scale from logical to pixel coordinates.
+ * Reallocates the surface and damages everything.
+ *
+ * @return false if the surface could not be allocated
+ */
+bool canvas_resize(GlCanvas* canvas, int width, int height, double scale);
+
+/**
+ * Present through a back buffer on the window instead of GL from now on.
+ * The caller then stops swapping GL buffers. Damages everything.
+ *
+ * @return false if the visual does not suit a back buffer (keep using GL)
+ */
+bool canvas_use_backbuffer(GlCanvas* canvas, Display* display, Window window, Visual* visual,
+                           int depth);
+
+/**
+ * Let the canvas see an X event (back buffer completion).
+ *
+ * @param redraw Set to true when a frame held back while the server was
+ *               reading the back buffer can be drawn now
+ * @return true if the event was consumed
+ */
+bool canvas_handle_event(GlCanvas* canvas, const XEvent* event, bool* redraw);
+
+/**
+ * Mark a rectangle, in logical coordinates, for redrawing. Overlapping or
+ * excess rectangles are merged, so damage is always a few rectangles at most.
+ */
+void canvas_damage(GlCanvas* canvas, double x, double y, double width, double height);
+
+/**
+ * Start drawing the damaged area.
+ *
+ * @return Context clipped to the damage and scaled to logical
+ *         coordinates, or NULL if nothing is damaged
+ */
+cairo_t* canvas_begin(GlCanvas* canvas);
+
+void canvas_end(GlCanvas* canvas, cairo_t* cr);
+
+/**
+ * Upload what was drawn since the last present and draw the texture over
+ * the whole viewport. Requires the GL context to be current.
+ *
+ * With a back buffer, send the damaged rectangles instead, or the whole
+ * image when nothing was drawn (an Expose).
+ */
+void canvas_present(GlCanvas* canvas);
+
+#endif // GRID_SEQ_GL_CANVAS_H
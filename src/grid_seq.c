@@ -14,6 +14,15 @@
 #include "state.h"
 #include "sequencer.h"
 #include "launchpad.h"
+#include "controls.h"
+#include "generator.h"
+#include "follow.h"
+#include "thru.h"
+#include "midi_clock.h"
+#include "clock_sync.h"
+#include "leds.h"
+#include "rtlog.h"
+#include "perf.h"
 
 #include <lv2/core/lv2.h>
 #include <lv2/atom/atom.h>
@@ -22,6 +31,7 @@
 #include <lv2/urid/urid.h>
 #include <lv2/midi/midi.h>
 #include <lv2/time/time.h>
+#include <lv2/worker/worker.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -53,14 +63,56 @@ typedef enum {
     PORT_GRID_ROW_14 = 22,
     PORT_GRID_ROW_15 = 23,
     PORT_SEQUENCE_LENGTH = 24,
-    PORT_MIDI_FILTER = 25
+    PORT_MIDI_FILTER = 25,
+    PORT_STEPS_PER_BEAT = 26,
+    PORT_LAUNCHPAD_LAYOUT = 27,
+    PORT_LAUNCHPAD2_IN = 28,
+    PORT_LAUNCHPAD2_OUT = 29,
+    PORT_LAUNCHPAD3_IN = 30,
+    PORT_LAUNCHPAD3_OUT = 31,
+    PORT_LAUNCHPAD4_IN = 32,
+    PORT_LAUNCHPAD4_OUT = 33,
+    PORT_LED_MODE = 34,
+    PORT_SCALE = 35,
+    PORT_KEY = 36,
+    PORT_FOLLOW_MODE = 37,
+    PORT_FOLLOW_CHANNEL = 38,
+    PORT_THRU_MODE = 39,
+    PORT_THRU_CHANNEL = 40,
+    PORT_CLOCK_OUT = 41,
+    PORT_CLOCK_SOURCE = 42,
+    PORT_FREEWHEEL = 43
 } PortIndex;
 
+// USB MIDI packets per second and device; keeps each link well below
+// saturation while a full 68-LED frame still goes out within ~10 ms
+#define LP_LINK_RATE 8000.0
+
+// USB MIDI event packets needed for a message (3 MIDI bytes each)
+#define LP_PACKETS(bytes) (((bytes) + 2) / 3)
+
+// Seconds between the Device Inquiries that notice a Launchpad being
+// unplugged and plugged back in
+#define LP_PROBE_INTERVAL 2.0
+
+// One Launchpad of the tiled surface. The first device uses midi_in and
+// launchpad_out, the others their own optional port pair.
+typedef struct {
+    const LV2_Atom_Sequence* in;
+    LV2_Atom_Sequence* out;
+    LV2_Atom_Forge forge;
+    LV2_Atom_Forge_Frame frame;
+    LedShadow leds;
+    bool mode_entered;
+    bool present;       // Answered the last probe, or was just initialised
+    bool probing;       // A probe is waiting for its reply
+    LedBucket link;     // Bandwidth left on the device's USB MIDI link
+} LaunchpadDevice;
+
 typedef struct {
     // Ports
     const LV2_Atom_Sequence* midi_in;
     LV2_Atom_Sequence* midi_out;
-    LV2_Atom_Sequence* launchpad_out;
     LV2_Atom_Sequence* notify;
     const float* grid_x;
     const float* grid_y;
@@ -69,26 +121,75 @@ typedef struct {
     float* grid_row[MAX_GRID_SIZE];
     const float* sequence_length;
     const float* midi_filter;
+    const float* steps_per_beat;
+    const float* launchpad_layout;
+    const float* led_mode;
+    const float* scale;
+    const float* key;
+    const float* follow_mode;
+    const float* follow_channel;
+    const float* thru_mode;
+    const float* thru_channel;
+    const float* clock_out;
+    const float* clock_source;
+    const float* freewheel;
 
     // Features
     LV2_URID_Map* map;
+    LV2_Worker_Schedule* schedule;
 
     // URIDs
     LV2_URID midi_MidiEvent;
     LV2_URID atom_Blank;
     LV2_URID atom_Object;
     LV2_URID atom_Int;
+    LV2_URID atom_Float;
+    LV2_URID atom_Double;
     LV2_URID time_Position;
     LV2_URID time_beatsPerMinute;
     LV2_URID time_speed;
+    LV2_URID time_beat;
     LV2_URID gridState;
     LV2_URID cellX;
     LV2_URID cellY;
     LV2_URID cellValue;
+    LV2_URID cellSet;
+    LV2_URID rowLength;
+    LV2_URID ratchet;
+    LV2_URID generate;
+    LV2_URID snapshotRequest;
+    LV2_URID gridEdit;
 
     // State
     GridSeqState state;
     SequencerURIDs seq_uris;
+    SeqQueue queue;        // Ratchet hits and their Note Offs still to come
+
+    // Generated pattern waiting for the next bar, and the cells it covers
+    GenPattern next_pattern;
+    GenPattern next_mask;
+    bool pattern_pending;
+
+    // Keyboard transpose and chord follow from midi_in
+    KeyFollow follow;
+
+    // midi_in events passed on to midi_out this block, in frame order
+    ThruFilter thru;
+    const LV2_Atom_Event* thru_events[THRU_MAX_EVENTS];
+    uint32_t thru_count;
+    uint32_t thru_next;
+    uint32_t thru_bytes;   // Written to midi_out so far this block
+
+    // MIDI beat clock on midi_out; this block's ticks are before clock_end
+    MidiClock clock;
+    uint64_t clock_end;
+
+    // MIDI clock slave: the transport follows clock on midi_in
+    ClockSync sync;
+    bool clock_slave;
+
+    // The host renders offline (lv2:freeWheeling port)
+    bool freewheeling;
 
     // Atom forge
     LV2_Atom_Forge forge;
@@ -98,12 +199,20 @@ typedef struct {
     float prev_grid_y;
 
     // Launchpad state
-    bool launchpad_mode_entered;
+    LaunchpadDevice devices[LP_MAX_DEVICES];
+    LpLayout layout;
+    ControlMap controls;   // Button and MIDI bindings
+    float last_length;     // sequence_length port value last applied
+    bool led_hardware;     // Let the device flash/pulse the playhead
     uint8_t prev_led_step;
     bool grid_dirty;
 
-    // Separate forge for Launchpad
-    LV2_Atom_Forge launchpad_forge;
+    // Control requests from the UI, sent once they fit into the outputs
+    bool pending_inquiry;
+    bool pending_reset;
+
+    // Frames since the last presence probe
+    uint32_t probe_elapsed;
 
     // Separate forge for UI notifications
     LV2_Atom_Forge notify_forge;
@@ -111,11 +220,38 @@ typedef struct {
     // Grid change counter
     uint32_t grid_change_counter;
 
-    // Track last toggled cell for UI notification
-    int8_t last_toggled_x;
-    int8_t last_toggled_y;
+    // What the UI last got in a gridState snapshot
+    bool snapshot_requested;
+    uint32_t snapshot_changes;
+    uint8_t snapshot_offset;
+    uint8_t snapshot_length;
+
+    // Diagnostics from run(), printed by the worker
+    RtLog log;
+    bool log_scheduled;
+
+    // Performance counters, published on notify
+    PerfCounters perf;
+    PerfURIDs perf_uris;
+    uint32_t log_dropped_seen;
 } GridSeq;
 
+// Worker messages: drain the diagnostic log, or run a generator
+#define WORK_DRAIN_LOG 1
+#define WORK_GENERATE 2
+
+// A generator request goes to the worker with the grid it works on, and
+// comes back with the generated pattern
+typedef struct {
+    uint32_t type;      // WORK_GENERATE
+    GenRequest request;
+    GenPattern pattern;
+} GenerateWork;
+
+// SysEx sizes: Programmer mode F0 00 20 29 02 0D 0E xx F7, inquiry F0 7E 7F 06 01 F7
+#define PROGRAMMER_SYSEX_SIZE 9
+#define INQUIRY_SYSEX_SIZE 6
+
 static LV2_Handle instantiate(
     const LV2_Descriptor* descriptor,
     double rate,
@@ -132,6 +268,8 @@ static LV2_Handle instantiate(
     for (int i = 0; features[i]; i++) {
         if (strcmp(features[i]->URI, LV2_URID__map) == 0) {
             gs->map = (LV2_URID_Map*)features[i]->data;
+        } else if (strcmp(features[i]->URI, LV2_WORKER__schedule) == 0) {
+            gs->schedule = (LV2_Worker_Schedule*)features[i]->data;
         }
     }
 
@@ -145,22 +283,50 @@ static LV2_Handle instantiate(
     gs->atom_Blank = gs->map->map(gs->map->handle, LV2_ATOM__Blank);
     gs->atom_Object = gs->map->map(gs->map->handle, LV2_ATOM__Object);
     gs->atom_Int = gs->map->map(gs->map->handle, LV2_ATOM__Int);
+    gs->atom_Float = gs->map->map(gs->map->handle, LV2_ATOM__Float);
+    gs->atom_Double = gs->map->map(gs->map->handle, LV2_ATOM__Double);
     gs->time_Position = gs->map->map(gs->map->handle, LV2_TIME__Position);
     gs->time_beatsPerMinute = gs->map->map(gs->map->handle, LV2_TIME__beatsPerMinute);
     gs->time_speed = gs->map->map(gs->map->handle, LV2_TIME__speed);
+    gs->time_beat = gs->map->map(gs->map->handle, LV2_TIME__beat);
     gs->gridState = gs->map->map(gs->map->handle, GRID_SEQ__gridState);
     gs->cellX = gs->map->map(gs->map->handle, GRID_SEQ__cellX);
     gs->cellY = gs->map->map(gs->map->handle, GRID_SEQ__cellY);
     gs->cellValue = gs->map->map(gs->map->handle, GRID_SEQ__cellValue);
+    gs->cellSet = gs->map->map(gs->map->handle, GRID_SEQ__cellSet);
+    gs->rowLength = gs->map->map(gs->map->handle, GRID_SEQ__rowLength);
+    gs->ratchet = gs->map->map(gs->map->handle, GRID_SEQ__ratchet);
+    gs->generate = gs->map->map(gs->map->handle, GRID_SEQ__generate);
+    gs->snapshotRequest = gs->map->map(gs->map->handle, GRID_SEQ__snapshotRequest);
+    gs->gridEdit = gs->map->map(gs->map->handle, GRID_SEQ__gridEdit);
 
     gs->seq_uris.midi_MidiEvent = gs->midi_MidiEvent;
 
+    gs->perf_uris.atom_Int = gs->atom_Int;
+    gs->perf_uris.atom_Long = gs->map->map(gs->map->handle, LV2_ATOM__Long);
+    gs->perf_uris.atom_Float = gs->atom_Float;
+    gs->perf_uris.perfStats = gs->map->map(gs->map->handle, GRID_SEQ__perfStats);
+    gs->perf_uris.perfBlocks = gs->map->map(gs->map->handle, GRID_SEQ__perfBlocks);
+    gs->perf_uris.perfFrames = gs->map->map(gs->map->handle, GRID_SEQ__perfFrames);
+    gs->perf_uris.perfRunNsMean = gs->map->map(gs->map->handle, GRID_SEQ__perfRunNsMean);
+    gs->perf_uris.perfRunNsMax = gs->map->map(gs->map->handle, GRID_SEQ__perfRunNsMax);
+    gs->perf_uris.perfRunNsHist = gs->map->map(gs->map->handle, GRID_SEQ__perfRunNsHist);
+    gs->perf_uris.perfDspLoad = gs->map->map(gs->map->handle, GRID_SEQ__perfDspLoad);
+    gs->perf_uris.perfStepHist = gs->map->map(gs->map->handle, GRID_SEQ__perfStepHist);
+    gs->perf_uris.perfEvents = gs->map->map(gs->map->handle, GRID_SEQ__perfEvents);
+    gs->perf_uris.perfHighWater = gs->map->map(gs->map->handle, GRID_SEQ__perfHighWater);
+    gs->perf_uris.perfCapacity = gs->map->map(gs->map->handle, GRID_SEQ__perfCapacity);
+    gs->perf_uris.perfOverflows = gs->map->map(gs->map->handle, GRID_SEQ__perfOverflows);
+    gs->perf_uris.perfLogDropped = gs->map->map(gs->map->handle, GRID_SEQ__perfLogDropped);
+
     // Initialize state
     state_init(&gs->state, rate);
 
     // Initialize atom forges
     lv2_atom_forge_init(&gs->forge, gs->map);
-    lv2_atom_forge_init(&gs->launchpad_forge, gs->map);
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        lv2_atom_forge_init(&gs->devices[d].forge, gs->map);
+    }
     lv2_atom_forge_init(&gs->notify_forge, gs->map);
 
     // Initialize grid state (empty - will be set by user or host state)
@@ -171,13 +337,31 @@ static LV2_Handle instantiate(
     gs->prev_grid_y = -1.0f;
 
     // Initialize Launchpad state
-    gs->launchpad_mode_entered = false;
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        gs->devices[d].mode_entered = false;
+        leds_bucket_init(&gs->devices[d].link, LP_LINK_RATE, LED_COUNT);
+        leds_init(&gs->devices[d].leds);
+    }
+    gs->layout = LP_LAYOUT_SINGLE;
+    controls_init(&gs->controls);
+    gs->last_length = -1.0f;
     gs->prev_led_step = 0;
     gs->grid_dirty = true;
 
-    // Initialize toggle tracking
-    gs->last_toggled_x = -1;
-    gs->last_toggled_y = -1;
+    // The UI asks for its first snapshot when it opens
+    gs->snapshot_requested = false;
+    gs->snapshot_changes = 0;
+    gs->snapshot_offset = gs->state.pitch_offset;
+    gs->snapshot_length = gs->state.sequence_length;
+
+    follow_init(&gs->follow);
+    midi_clock_init(&gs->clock);
+    clock_sync_init(&gs->sync, rate);
+    follow_build_offsets(&gs->follow, &gs->state);
+
+    // Without a worker, run() diagnostics are counted as dropped
+    rtlog_init(&gs->log);
+    perf_init(&gs->perf, rate);
 
     return (LV2_Handle)gs;
 }
@@ -197,7 +381,7 @@ static void connect_port(
             gs->midi_out = (LV2_Atom_Sequence*)data;
             break;
         case PORT_LAUNCHPAD_OUT:
-            gs->launchpad_out = (LV2_Atom_Sequence*)data;
+            gs->devices[0].out = (LV2_Atom_Sequence*)data;
             break;
         case PORT_NOTIFY:
             gs->notify = (LV2_Atom_Sequence*)data;
@@ -238,6 +422,52 @@ static void connect_port(
         case PORT_MIDI_FILTER:
             gs->midi_filter = (const float*)data;
             break;
+        case PORT_STEPS_PER_BEAT:
+            gs->steps_per_beat = (const float*)data;
+            break;
+        case PORT_LAUNCHPAD_LAYOUT:
+            gs->launchpad_layout = (const float*)data;
+            break;
+        case PORT_LED_MODE:
+            gs->led_mode = (const float*)data;
+            break;
+        case PORT_SCALE:
+            gs->scale = (const float*)data;
+            break;
+        case PORT_KEY:
+            gs->key = (const float*)data;
+            break;
+        case PORT_FOLLOW_MODE:
+            gs->follow_mode = (const float*)data;
+            break;
+        case PORT_FOLLOW_CHANNEL:
+            gs->follow_channel = (const float*)data;
+            break;
+        case PORT_THRU_MODE:
+            gs->thru_mode = (const float*)data;
+            break;
+        case PORT_THRU_CHANNEL:
+            gs->thru_channel = (const float*)data;
+            break;
+        case PORT_CLOCK_OUT:
+            gs->clock_out = (const float*)data;
+            break;
+        case PORT_CLOCK_SOURCE:
+            gs->clock_source = (const float*)data;
+            break;
+        case PORT_FREEWHEEL:
+            gs->freewheel = (const float*)data;
+            break;
+        case PORT_LAUNCHPAD2_IN:
+        case PORT_LAUNCHPAD3_IN:
+        case PORT_LAUNCHPAD4_IN:
+            gs->devices[1 + (port - PORT_LAUNCHPAD2_IN) / 2].in = (const LV2_Atom_Sequence*)data;
+            break;
+        case PORT_LAUNCHPAD2_OUT:
+        case PORT_LAUNCHPAD3_OUT:
+        case PORT_LAUNCHPAD4_OUT:
+            gs->devices[1 + (port - PORT_LAUNCHPAD2_OUT) / 2].out = (LV2_Atom_Sequence*)data;
+            break;
     }
 }
 
@@ -274,99 +504,356 @@ static void read_grid_row_ports(GridSeq* gs) {
     }
 }
 
+// All Launchpad outputs are counted together as PERF_PORT_LAUNCHPAD_OUT
+static PerfPort forge_port(const GridSeq* gs, const LV2_Atom_Forge* forge) {
+    if (forge == &gs->forge) return PERF_PORT_MIDI_OUT;
+    if (forge == &gs->notify_forge) return PERF_PORT_NOTIFY;
+    return PERF_PORT_LAUNCHPAD_OUT;
+}
+
+static void send_midi(GridSeq* gs, LV2_Atom_Forge* forge, const uint8_t* msg, uint32_t size) {
+    if (!sequencer_write_midi(forge, &gs->seq_uris, 0, msg, size)) {
+        perf_record_overflow(&gs->perf, forge_port(gs, forge), 1);
+    }
+}
+
 static void send_sysex_programmer_mode(GridSeq* gs, LV2_Atom_Forge* forge, bool enter) {
     // SysEx: F0 00 20 29 02 0D 0E [01/00] F7
     uint8_t sysex[] = {0xF0, 0x00, 0x20, 0x29, 0x02, 0x0D, 0x0E, enter ? 0x01 : 0x00, 0xF7};
 
-    fprintf(stderr, "grid-seq: Sending SysEx to %s Programmer Mode\n", enter ? "ENTER" : "EXIT");
-    fprintf(stderr, "  SysEx bytes: ");
-    for (size_t i = 0; i < sizeof(sysex); i++) {
-        fprintf(stderr, "%02X ", sysex[i]);
-    }
-    fprintf(stderr, "\n");
+    rtlog_write(&gs->log, enter ? "grid-seq: Sending SysEx to ENTER Programmer Mode"
+                                : "grid-seq: Sending SysEx to EXIT Programmer Mode");
 
-    lv2_atom_forge_frame_time(forge, 0);
-    lv2_atom_forge_atom(forge, sizeof(sysex), gs->midi_MidiEvent);
-    lv2_atom_forge_write(forge, sysex, sizeof(sysex));
+    send_midi(gs, forge, sysex, sizeof(sysex));
 }
 
-static void send_launchpad_led(GridSeq* gs, LV2_Atom_Forge* forge, uint8_t note, uint8_t color) {
-    // LED commands use Note On channel 1 (0x90) in Programmer Mode
-    // Launchpad expects LED updates as Note On messages with velocity = color
-    // Musical notes go to midi_out, LED commands go to launchpad_out (separate ports)
-    uint8_t msg[3] = {0x90, note, color};
+static void send_inquiry(GridSeq* gs, LV2_Atom_Forge* forge) {
+    // Universal Device Inquiry SysEx: F0 7E 7F 06 01 F7
+    const uint8_t inquiry[INQUIRY_SYSEX_SIZE] = {0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7};
 
-    lv2_atom_forge_frame_time(forge, 0);
-    lv2_atom_forge_atom(forge, 3, gs->midi_MidiEvent);
-    lv2_atom_forge_write(forge, msg, 3);
+    send_midi(gs, forge, inquiry, sizeof(inquiry));
 }
 
-static void send_launchpad_cc_led(GridSeq* gs, LV2_Atom_Forge* forge, uint8_t cc, uint8_t color) {
-    // Send CC LED commands for control buttons (arrows, etc.)
-    uint8_t msg[3] = {0xB0, cc, color};
+// Check that a control message leaves room for `reserve` bytes of notes
+static bool control_fits(const LV2_Atom_Forge* forge, uint32_t bytes, uint32_t reserve) {
+    return forge->offset + bytes + reserve <= forge->size;
+}
 
-    lv2_atom_forge_frame_time(forge, 0);
-    lv2_atom_forge_atom(forge, 3, gs->midi_MidiEvent);
-    lv2_atom_forge_write(forge, msg, 3);
+// First step shown on the surface: paged with the arrows on a single
+// device, fixed at 0 when the surface is 16 steps wide
+static uint8_t surface_first_step(const GridSeq* gs) {
+    return gs->layout == LP_LAYOUT_SINGLE ? gs->state.hardware_page * 8 : 0;
 }
 
-static void update_launchpad_leds(GridSeq* gs, LV2_Atom_Forge* forge) {
-    // Calculate which steps to show based on current hardware page
-    uint8_t page_offset = gs->state.hardware_page * 8;
+// Highest pitch_offset that keeps every surface row inside the MIDI range
+static uint8_t surface_max_pitch_offset(const GridSeq* gs) {
+    return GRID_PITCH_RANGE - lp_layout_rows(gs->layout);
+}
 
-    static int debug_count = 0;
-    if (debug_count < 3) {
-        fprintf(stderr, "grid-seq: LED update - pitch_offset=%d, hardware_page=%d\n",
-                gs->state.pitch_offset, gs->state.hardware_page);
-        debug_count++;
+static void render_pad(const GridSeq* gs, LedShadow* leds, uint8_t x, uint8_t y, uint8_t sx, uint8_t sy) {
+    uint8_t actual_step = surface_first_step(gs) + sx;
+    uint8_t actual_note = gs->state.pitch_offset + sy;
+    bool active = actual_step < MAX_GRID_SIZE && gs->state.grid[actual_step][actual_note];
+    const uint8_t row_step = state_row_step(&gs->state, actual_note);
+
+    // If this column is beyond the row's loop, or the scale gives the row
+    // no note, turn it off
+    if (actual_step >= state_row_length(&gs->state, actual_note) ||
+        state_row_note(&gs->state, actual_note) == SCALE_NO_NOTE) {
+        leds_set_pad(leds, x, y, LP_COLOR_OFF);
     }
-
-    for (uint8_t x = 0; x < 8; x++) {
-        for (uint8_t y = 0; y < 8; y++) {
-            uint8_t note = lp_grid_to_note(x, y);
-            uint8_t actual_step = page_offset + x;
-            uint8_t actual_note = gs->state.pitch_offset + y;
-            uint8_t color;
-
-            // If this column is beyond sequence length, turn it off
-            if (actual_step >= gs->state.sequence_length) {
-                color = LP_COLOR_OFF;
-            }
-            // Check if this is the current playing step
-            else if (actual_step == gs->state.current_step) {
-                color = gs->state.grid[actual_step][actual_note] ? LP_COLOR_YELLOW : LP_COLOR_GREEN_DIM;
-            }
-            // Normal step coloring
-            else {
-                color = gs->state.grid[actual_step][actual_note] ? LP_COLOR_GREEN : LP_COLOR_OFF;
-            }
-
-            send_launchpad_led(gs, forge, note, color);
-
-            if (debug_count < 3 && color != LP_COLOR_OFF) {
-                fprintf(stderr, "  LED[%d,%d] note=%d color=%d (grid[%d][%d]=%d)\n",
-                        x, y, note, color, actual_step, actual_note, gs->state.grid[actual_step][actual_note]);
-            }
+    // Hardware animation: the device flashes the playhead's notes while
+    // playing and pulses them while stopped (armed), so moving the
+    // playhead only touches the notes it leaves and enters
+    else if (gs->led_hardware && actual_step == row_step) {
+        if (!active) {
+            leds_set_pad(leds, x, y, LP_COLOR_OFF);
+        } else if (gs->state.playing) {
+            leds_set_pad_animated(leds, x, y, LP_COLOR_GREEN, LP_COLOR_YELLOW, LED_FLASH);
+        } else {
+            leds_set_pad_animated(leds, x, y, LP_COLOR_GREEN, LP_COLOR_GREEN, LED_PULSE);
+        }
+    }
+    // A generated pattern waiting for the bar pulses the notes it will
+    // set and flashes the ones it will clear
+    else if (gs->pattern_pending && actual_step != row_step &&
+             generator_cell(&gs->next_mask, actual_step, actual_note) &&
+             (active || generator_cell(&gs->next_pattern, actual_step, actual_note))) {
+        if (generator_cell(&gs->next_pattern, actual_step, actual_note)) {
+            leds_set_pad_animated(leds, x, y, LP_COLOR_GREEN, LP_COLOR_GREEN, LED_PULSE);
+        } else {
+            leds_set_pad_animated(leds, x, y, LP_COLOR_GREEN, LP_COLOR_OFF, LED_FLASH);
         }
     }
+    // Muted rows show their notes in red
+    else if (active && gs->state.muted[actual_note] && actual_step != row_step) {
+        leds_set_pad(leds, x, y, LP_COLOR_RED);
+    }
+    // Check if this is the current playing step
+    else if (actual_step == row_step) {
+        leds_set_pad(leds, x, y, active ? LP_COLOR_YELLOW : LP_COLOR_GREEN_DIM);
+    }
+    // Normal step coloring
+    else {
+        leds_set_pad(leds, x, y, active ? LP_COLOR_GREEN : LP_COLOR_OFF);
+    }
+}
 
-    // Light up arrow buttons based on current page and sequence length
+static void update_launchpad_leds(GridSeq* gs) {
+    // Arrow buttons are the same on every device
     // Left arrow (CC 93) - only lit if we can go left
-    uint8_t left_color = (gs->state.hardware_page > 0) ? LP_COLOR_WHITE : LP_COLOR_OFF;
-    send_launchpad_cc_led(gs, forge, 93, left_color);
+    uint8_t left_color = (gs->layout == LP_LAYOUT_SINGLE && gs->state.hardware_page > 0) ? LP_COLOR_WHITE : LP_COLOR_OFF;
 
     // Right arrow (CC 94) - only lit if sequence length > 8 and we can go right
-    uint8_t right_color = (gs->state.sequence_length > 8 && gs->state.hardware_page == 0) ? LP_COLOR_WHITE : LP_COLOR_OFF;
-    send_launchpad_cc_led(gs, forge, 94, right_color);
+    uint8_t right_color = (gs->layout == LP_LAYOUT_SINGLE && gs->state.sequence_length > 8 &&
+                           gs->state.hardware_page == 0) ? LP_COLOR_WHITE : LP_COLOR_OFF;
 
     // Up/Down pitch shift buttons (CC 91/92)
     // CC 91 (down) - lit if we can shift down
     uint8_t down_color = (gs->state.pitch_offset > 0) ? LP_COLOR_WHITE : LP_COLOR_OFF;
-    send_launchpad_cc_led(gs, forge, 91, down_color);
 
     // CC 92 (up) - lit if we can shift up
-    uint8_t up_color = (gs->state.pitch_offset < (GRID_PITCH_RANGE - GRID_VISIBLE_ROWS)) ? LP_COLOR_WHITE : LP_COLOR_OFF;
-    send_launchpad_cc_led(gs, forge, 92, up_color);
+    uint8_t up_color = (gs->state.pitch_offset < surface_max_pitch_offset(gs)) ? LP_COLOR_WHITE : LP_COLOR_OFF;
+
+    for (uint8_t d = 0; d < lp_layout_devices(gs->layout); d++) {
+        LedShadow* leds = &gs->devices[d].leds;
+        LpTile tile = lp_layout_tile(gs->layout, d);
+
+        for (uint8_t x = 0; x < 8; x++) {
+            for (uint8_t y = 0; y < 8; y++) {
+                render_pad(gs, leds, x, y, tile.col + x, tile.row + y);
+            }
+        }
+
+        leds_set_cc(leds, 93, left_color);
+        leds_set_cc(leds, 94, right_color);
+        leds_set_cc(leds, 91, down_color);
+        leds_set_cc(leds, 92, up_color);
+    }
+}
+
+// Switch the tiling; devices that drop out re-enter Programmer Mode when
+// they are used again
+static void set_layout(GridSeq* gs, LpLayout layout) {
+    for (uint8_t d = lp_layout_devices(layout); d < LP_MAX_DEVICES; d++) {
+        gs->devices[d].mode_entered = false;
+    }
+
+    gs->layout = layout;
+    if (gs->state.pitch_offset > surface_max_pitch_offset(gs)) {
+        gs->state.pitch_offset = surface_max_pitch_offset(gs);
+    }
+    gs->grid_dirty = true;
+
+    rtlog_write(&gs->log, "grid-seq: Launchpad layout %d (%d devices, %dx%d)",
+                layout, lp_layout_devices(layout), lp_layout_columns(layout), lp_layout_rows(layout));
+}
+
+// Hand a generator request to the worker. A request made while another
+// result waits for its bar builds on that result.
+static void request_generate(GridSeq* gs, const GenRequest* request) {
+    if (!gs->schedule) {
+        rtlog_write(&gs->log, "grid-seq: Pattern generators need the host's worker");
+        return;
+    }
+
+    GenerateWork work;
+    work.type = WORK_GENERATE;
+    work.request = *request;
+    generator_capture(&gs->state, &work.pattern);
+    if (gs->pattern_pending) {
+        generator_overlay(&work.pattern, &gs->next_pattern, &gs->next_mask);
+    }
+
+    if (gs->schedule->schedule_work(gs->schedule->handle, sizeof(work), &work) != LV2_WORKER_SUCCESS) {
+        rtlog_write(&gs->log, "grid-seq: Worker busy, generator request dropped");
+    }
+}
+
+// Launchpad generator: each press adds one hit to the row's Euclidean
+// rhythm over its loop, wrapping back to an empty row
+static void generate_row_euclid(GridSeq* gs, uint8_t note) {
+    const uint8_t length = state_row_length(&gs->state, note);
+    uint8_t hits = 0;
+    for (uint8_t x = 0; x < length; x++) {
+        if (gs->state.grid[x][note]) hits++;
+    }
+
+    GenRequest request;
+    memset(&request, 0, sizeof(request));
+    request.algorithm = GEN_EUCLID;
+    request.note = note;
+    request.rows = 1;
+    request.steps = length;
+    request.hits = (uint8_t)((hits + 1) % (length + 1));
+    request_generate(gs, &request);
+}
+
+// Pad presses, arrow buttons and Device Inquiry replies from one Launchpad.
+// Returns false for messages that are none of these.
+static bool handle_launchpad_midi(GridSeq* gs, uint8_t device, const uint8_t* msg, uint32_t size) {
+    if (size == 0) return false;
+
+    // A Launchpad answering a Device Inquiry after missing a probe was
+    // replugged or power cycled and is back in its default mode: re-enter
+    // Programmer Mode and resend the full LED frame in this block
+    if (msg[0] == 0xF0) {
+        if (lp_parse_inquiry_reply(msg, size, NULL)) {
+            LaunchpadDevice* dev = &gs->devices[device];
+            dev->probing = false;
+            if (!dev->present) {
+                dev->mode_entered = false;
+                rtlog_write(&gs->log, "grid-seq: Launchpad %d identified, re-initialising", device + 1);
+            }
+            return true;
+        }
+        return false;
+    }
+    if (size < 3) return false;
+
+    // Bound buttons and messages: one table lookup, whatever the button
+    bool pressed = false;
+    const ControlBinding* binding = controls_lookup(&gs->controls, msg, size, gs->state.shift, &pressed);
+    if (binding) {
+        const LpTile tile = lp_layout_tile(gs->layout, device);
+        if (binding->action == CONTROL_GENERATE) {
+            const uint32_t note = (uint32_t)gs->state.pitch_offset + tile.row + binding->param;
+            if (pressed && note < GRID_PITCH_RANGE) generate_row_euclid(gs, (uint8_t)note);
+            return true;
+        }
+
+        const ControlSurface surface = {
+            tile.row, lp_layout_rows(gs->layout), gs->layout == LP_LAYOUT_SINGLE
+        };
+        if (controls_apply(&gs->state, binding, pressed, &surface)) {
+            gs->grid_dirty = true;
+            rtlog_write(&gs->log, "grid-seq: Control %d: pitch offset %d, page %d, length %d",
+                        binding->action, gs->state.pitch_offset,
+                        gs->state.hardware_page, gs->state.sequence_length);
+        }
+        return true;
+    }
+
+    // Grid pads on channel 1: Note On (0x90) toggles, release is ignored
+    uint8_t sx, sy;
+    if (msg[0] != 0x90 || !lp_note_to_surface(lp_layout_tile(gs->layout, device), msg[1], &sx, &sy)) {
+        return false;
+    }
+    if (msg[2] == 0) return true;
+
+    // Calculate actual grid position based on hardware page and pitch offset
+    uint8_t actual_x = sx + surface_first_step(gs);
+    uint8_t actual_y = sy + gs->state.pitch_offset;
+    if (actual_x < gs->state.sequence_length && actual_y < GRID_PITCH_RANGE) {
+        rtlog_write(&gs->log, "grid-seq: Pad (%d,%d) toggling grid[%d][%d]",
+                    sx, sy, actual_x, actual_y);
+        state_toggle_step(&gs->state, actual_x, actual_y);
+        gs->grid_dirty = true;
+        gs->grid_change_counter++;
+
+        // The player waits for this LED; it skips the queue
+        LpTile tile = lp_layout_tile(gs->layout, device);
+        leds_mark_urgent(&gs->devices[device].leds, sx - tile.col, sy - tile.row);
+    }
+    return true;
+}
+
+// Set one cell from the UI piano roll, addressed by absolute note
+static void handle_cell_set(GridSeq* gs, const LV2_Atom_Object* obj) {
+    const LV2_Atom* x_atom = NULL;
+    const LV2_Atom* y_atom = NULL;
+    const LV2_Atom* value_atom = NULL;
+
+    lv2_atom_object_get(obj,
+        gs->cellX, &x_atom,
+        gs->cellY, &y_atom,
+        gs->cellValue, &value_atom,
+        0);
+
+    if (!x_atom || !y_atom || !value_atom || x_atom->type != gs->atom_Int ||
+        y_atom->type != gs->atom_Int || value_atom->type != gs->atom_Int) {
+        return;
+    }
+
+    int32_t x = ((const LV2_Atom_Int*)x_atom)->body;
+    int32_t y = ((const LV2_Atom_Int*)y_atom)->body;
+    bool value = ((const LV2_Atom_Int*)value_atom)->body != 0;
+    if (x < 0 || x >= MAX_GRID_SIZE || y < 0 || y >= GRID_PITCH_RANGE) return;
+
+    if (gs->state.grid[x][y] != value) {
+        gs->state.grid[x][y] = value;
+        gs->grid_dirty = true;
+        gs->grid_change_counter++;
+        rtlog_write(&gs->log, "grid-seq: UI set cell [%d,%d] to %d", x, y, value);
+    }
+}
+
+// Give one row its own loop length, or let it follow the sequence again
+static void handle_row_length(GridSeq* gs, const LV2_Atom_Object* obj) {
+    const LV2_Atom* note_atom = NULL;
+    const LV2_Atom* length_atom = NULL;
+
+    lv2_atom_object_get(obj,
+        gs->cellY, &note_atom,
+        gs->cellValue, &length_atom,
+        0);
+
+    if (!note_atom || !length_atom || note_atom->type != gs->atom_Int ||
+        length_atom->type != gs->atom_Int) {
+        return;
+    }
+
+    int32_t note = ((const LV2_Atom_Int*)note_atom)->body;
+    int32_t length = ((const LV2_Atom_Int*)length_atom)->body;
+    if (note < 0 || note >= GRID_PITCH_RANGE || length < 0 || length > MAX_SEQUENCE_LENGTH) return;
+
+    if (gs->state.row_length[note] != length) {
+        state_set_row_length(&gs->state, (uint8_t)note, (uint8_t)length);
+        gs->grid_dirty = true;
+        gs->grid_change_counter++;
+        rtlog_write(&gs->log, "grid-seq: UI set row %d length to %d", note, length);
+    }
+}
+
+// Set how often one cell retriggers within its step
+static void handle_ratchet(GridSeq* gs, const LV2_Atom_Object* obj) {
+    const LV2_Atom* x_atom = NULL;
+    const LV2_Atom* y_atom = NULL;
+    const LV2_Atom* hits_atom = NULL;
+
+    lv2_atom_object_get(obj,
+        gs->cellX, &x_atom,
+        gs->cellY, &y_atom,
+        gs->cellValue, &hits_atom,
+        0);
+
+    if (!x_atom || !y_atom || !hits_atom || x_atom->type != gs->atom_Int ||
+        y_atom->type != gs->atom_Int || hits_atom->type != gs->atom_Int) {
+        return;
+    }
+
+    int32_t x = ((const LV2_Atom_Int*)x_atom)->body;
+    int32_t y = ((const LV2_Atom_Int*)y_atom)->body;
+    int32_t hits = ((const LV2_Atom_Int*)hits_atom)->body;
+    if (x < 0 || x >= MAX_GRID_SIZE || y < 0 || y >= GRID_PITCH_RANGE || hits < 0 || hits > MAX_RATCHET) {
+        return;
+    }
+
+    if (state_ratchet(&gs->state, (uint8_t)x, (uint8_t)y) != (hits > 1 ? hits : 1)) {
+        state_set_ratchet(&gs->state, (uint8_t)x, (uint8_t)y, (uint8_t)hits);
+        gs->grid_change_counter++;
+        rtlog_write(&gs->log, "grid-seq: UI set cell [%d,%d] ratchet to %d", x, y, hits);
+    }
+}
+
+// Apply one UI edit transaction as a single grid change
+static void handle_grid_edit(GridSeq* gs, const GridEdit* edit) {
+    uint32_t changed = state_apply_edit(&gs->state, edit);
+    if (changed) {
+        gs->grid_dirty = true;
+        gs->grid_change_counter++;
+        rtlog_write(&gs->log, "grid-seq: UI edit changed %d cells", (int)changed);
+    }
 }
 
 static void activate(LV2_Handle instance) {
@@ -379,46 +866,359 @@ static void activate(LV2_Handle instance) {
     // COMMENTED OUT to test if persisted data is the problem
     // read_grid_row_ports(gs);
 
-    // Reset launchpad mode flag so SysEx is sent again on next run()
-    gs->launchpad_mode_entered = false;
+    // Reset launchpad mode flags so SysEx is sent again on next run()
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        gs->devices[d].mode_entered = false;
+        gs->devices[d].probing = false;
+    }
+    gs->probe_elapsed = 0;
 
     gs->state.playing = true;
+    sequencer_queue_clear(&gs->queue);
     gs->state.frame_counter = 0;
+    gs->state.point_due = false;
     gs->state.current_step = 0;
     gs->state.previous_step = GRID_SIZE - 1;  // Set to last step so first step triggers
     gs->state.first_run = true;
     gs->grid_dirty = true;  // Force LED update on first run
 }
 
+// Count events and bytes written to one output sequence
+static void record_port(GridSeq* gs, PerfPort port, const LV2_Atom_Sequence* seq, uint32_t capacity) {
+    uint32_t events = 0;
+    LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+        events++;
+    }
+    perf_record_port(&gs->perf, port, events, (uint32_t)sizeof(LV2_Atom) + seq->atom.size, capacity);
+}
+
+// Start the transport at a sequencer frame; `beat` is the song position
+// external gear starts from
+static void start_transport(GridSeq* gs, uint64_t frame, double beat) {
+    gs->state.playing = true;
+    gs->state.frame_counter = frame;
+    gs->state.point_due = false;
+    gs->state.current_step = (uint8_t)(frame / gs->state.frames_per_step % gs->state.sequence_length);
+    sequencer_queue_restart(&gs->queue);
+    midi_clock_start(&gs->clock, beat);
+
+    // The animated playhead flashes or pulses by transport
+    gs->grid_dirty = true;
+}
+
+static void stop_transport(GridSeq* gs) {
+    gs->state.playing = false;
+    midi_clock_stop(&gs->clock);
+    gs->grid_dirty = true;
+}
+
+static void handle_clock_action(GridSeq* gs, ClockSyncAction action) {
+    if (action == CLOCK_SYNC_START) {
+        const uint64_t fpb = gs->state.frames_per_step * gs->state.steps_per_beat;
+        start_transport(gs, clock_sync_tick_frame(gs->sync.tick, fpb),
+                        (double)gs->sync.tick / CLOCK_SYNC_PPQN);
+    } else if (action == CLOCK_SYNC_STOP) {
+        stop_transport(gs);
+    }
+}
+
+// Frames the sequencer moves on in this block while it follows MIDI
+// clock: up to where the ticks received so far put it, at most one block.
+// When it is further behind (while the loop locks, or after a tempo
+// jump) it first skips ahead, but never past a step, a half-step Note
+// Off point or a clock tick, so none of them is lost.
+static uint32_t follow_clock(GridSeq* gs, uint32_t n_samples) {
+    // Take over the tracked tempo, keeping the position on the new step
+    // grid (the target below is computed on it)
+    const double bpm = clock_sync_bpm(&gs->sync);
+    if (bpm > 0.0) {
+        const uint64_t old_fps = gs->state.frames_per_step;
+        state_update_tempo(&gs->state, bpm * (1.0 + CLOCK_SYNC_LEAD));
+        if (gs->state.frames_per_step != old_fps) {
+            gs->state.frame_counter = gs->state.frame_counter * gs->state.frames_per_step / old_fps;
+        }
+    }
+
+    if (!gs->state.playing) return 0;
+
+    const uint64_t fpb = gs->state.frames_per_step * gs->state.steps_per_beat;
+    const uint64_t target = clock_sync_target(&gs->sync, n_samples, fpb);
+    const uint64_t frame = gs->state.frame_counter;
+    if (target <= frame) return 0;
+
+    // A point left due is played before anything is skipped
+    if (target - frame > n_samples && !gs->state.point_due) {
+        const uint64_t fps = gs->state.frames_per_step;
+        const uint64_t step_start = frame / fps * fps;
+        uint64_t limit = step_start + fps - 1;
+        if (frame < step_start + fps / 2) limit = step_start + fps / 2 - 1;
+        const uint64_t tick = clock_sync_tick_frame((frame * CLOCK_SYNC_PPQN + fpb - 1) / fpb, fpb);
+        if (tick < limit) limit = tick;
+
+        const uint64_t skip = target - frame - n_samples;
+        gs->state.frame_counter = limit > frame + skip ? frame + skip : (limit > frame ? limit : frame);
+    }
+
+    const uint64_t behind = target - gs->state.frame_counter;
+    return behind < n_samples ? (uint32_t)behind : n_samples;
+}
+
+// Next clock tick of this block, UINT64_MAX when there is none
+static uint64_t next_clock_frame(const GridSeq* gs) {
+    const uint64_t frame = midi_clock_next_frame(&gs->clock, &gs->state);
+    return frame < gs->clock_end ? frame : UINT64_MAX;
+}
+
+// Write the clock ticks and thru events due before `until` to midi_out.
+// Each goes in after the queued notes up to its frame (generated notes
+// first on a tie, a tick before a thru event), so the already ordered
+// streams merge linearly. Thru events only take the space this block's
+// notes and ticks leave free.
+static uint32_t merge_events(GridSeq* gs, uint64_t block_start, uint64_t until,
+                             uint32_t notes_start, uint32_t note_reserve, uint32_t* thru_dropped) {
+    uint32_t notes_dropped = 0;
+
+    for (;;) {
+        const LV2_Atom_Event* ev = gs->thru_next < gs->thru_count ? gs->thru_events[gs->thru_next] : NULL;
+        const uint64_t thru_frame = ev ? block_start + (uint64_t)ev->time.frames : UINT64_MAX;
+        const uint64_t tick_frame = next_clock_frame(gs);
+        const uint64_t frame = tick_frame <= thru_frame ? tick_frame : thru_frame;
+        if (frame >= until) break;
+
+        if (gs->state.playing) {
+            notes_dropped += sequencer_process_queue(&gs->queue, &gs->forge, &gs->seq_uris,
+                                                     block_start, frame + 1);
+        }
+
+        if (tick_frame <= thru_frame) {
+            if (!midi_clock_write_tick(&gs->clock, &gs->state, &gs->forge, &gs->seq_uris, block_start)) {
+                notes_dropped++;
+            }
+            continue;
+        }
+        gs->thru_next++;
+
+        const uint32_t notes_written = gs->forge.offset - notes_start - gs->thru_bytes;
+        const uint32_t reserve = note_reserve > notes_written ? note_reserve - notes_written : 0;
+        const uint32_t bytes = sequencer_midi_event_size(ev->body.size);
+        if (control_fits(&gs->forge, bytes, reserve) &&
+            sequencer_write_midi(&gs->forge, &gs->seq_uris, (uint32_t)ev->time.frames,
+                                 (const uint8_t*)(ev + 1), ev->body.size)) {
+            gs->thru_bytes += bytes;
+        } else {
+            (*thru_dropped)++;
+        }
+    }
+    return notes_dropped;
+}
+
+// A step starts playing, or the transport stands still: the LEDs follow
+// the playhead, and pending pattern and keyboard follow changes take over
+static void begin_step(GridSeq* gs, bool play_step) {
+    if (play_step) gs->grid_dirty = true;  // Update LEDs when step changes
+
+    // A generated pattern takes over as the bar starts (the sequence
+    // wrapping to step 0), or at once while stopped
+    if (gs->pattern_pending && (!gs->state.playing || (play_step && gs->state.current_step == 0))) {
+        uint32_t changed = generator_apply(&gs->state, &gs->next_pattern, &gs->next_mask);
+        gs->pattern_pending = false;
+        gs->grid_dirty = true;  // The queued cells stop pulsing
+        if (changed) {
+            gs->grid_change_counter++;
+            rtlog_write(&gs->log, "grid-seq: Generated pattern changed %d cells", (int)changed);
+        }
+    }
+
+    // Keyboard follow: a new transposition or chord takes over as the next
+    // step starts, or at once while stopped
+    if (gs->follow.dirty && (!gs->state.playing || play_step)) {
+        follow_build_offsets(&gs->follow, &gs->state);
+    }
+}
+
+// Hits a row can play on an absolute step of a block played point by
+// point: as the sequencer plays it, but at the row's own step, with a
+// pending pattern once the bar has started, and whatever a keyboard
+// follow offset does meanwhile
+static uint8_t points_row_hits(const GridSeq* gs, uint64_t step, bool swapped, uint8_t row) {
+    const GridSeqState* state = &gs->state;
+    if (state->muted[row] || state_row_note(state, row) == SCALE_NO_NOTE) return 0;
+
+    const uint8_t length = state_row_length(state, row);
+    const uint8_t x = (uint8_t)(step % length);
+    bool on = state->grid[x][row];
+    if (swapped && generator_cell(&gs->next_mask, x, row)) {
+        on = generator_cell(&gs->next_pattern, x, row);
+    }
+    if (on) return state_ratchet(state, x, row);
+    if (!state->fill) return 0;
+
+    for (uint8_t i = 0; i < length && i < MAX_GRID_SIZE; i++) {
+        on = state->grid[i][row];
+        if (swapped && generator_cell(&gs->next_mask, i, row)) {
+            on = generator_cell(&gs->next_pattern, i, row);
+        }
+        if (on) return 1;
+    }
+    return 0;
+}
+
+// Note Ons and Note Offs of the steps a block plays point by point, every
+// hit with its Note Off, plus the notes still sounding. A step on the
+// block's start plays here only if the last block left it due.
+static uint32_t points_note_count(const GridSeq* gs, const SeqBlock* block) {
+    const GridSeqState* state = &gs->state;
+    const uint64_t fps = state->frames_per_step;
+    uint32_t count = sequencer_active_note_count(state);
+
+    uint64_t step = (block->start + fps - 1) / fps;
+    if (step * fps == block->start && !state->point_due) step++;
+
+    bool swapped = false;
+    for (; step * fps < block->until; step++) {
+        if (gs->pattern_pending && step % state->sequence_length == 0) swapped = true;
+        for (uint8_t row = 0; row < GRID_PITCH_RANGE; row++) {
+            count += 2 * points_row_hits(gs, step, swapped, row);
+        }
+    }
+    return count;
+}
+
 static void run(LV2_Handle instance, uint32_t n_samples) {
     GridSeq* gs = (GridSeq*)instance;
+    const uint64_t run_start = perf_now_ns();
+
+    // While the host bounces offline only the notes matter, as fast as
+    // possible: LED and UI traffic and logging wait until it is back in
+    // real time, and every block is played point by point
+    const bool freewheeling = gs->freewheel && *gs->freewheel > 0.5f;
+    if (freewheeling != gs->freewheeling) {
+        gs->freewheeling = freewheeling;
+        rtlog_set_muted(&gs->log, freewheeling);
+        gs->grid_dirty = true;
+    }
 
-    // Read sequence length from port and update state
-    if (gs->sequence_length) {
+    // Read sequence length from port and update state. Only a port change
+    // is applied, so a length set from the Launchpad holds until then.
+    if (gs->sequence_length && *gs->sequence_length != gs->last_length) {
+        gs->last_length = *gs->sequence_length;
         uint8_t new_length = (uint8_t)(*gs->sequence_length);
         if (new_length >= MIN_SEQUENCE_LENGTH && new_length <= MAX_SEQUENCE_LENGTH) {
             gs->state.sequence_length = new_length;
         }
     }
 
+    // Read step resolution and recalculate step timing when it changes
+    if (gs->steps_per_beat) {
+        uint8_t new_resolution = (uint8_t)(*gs->steps_per_beat);
+        if (new_resolution >= 1 && new_resolution <= MAX_STEPS_PER_BEAT &&
+            new_resolution != gs->state.steps_per_beat) {
+            gs->state.steps_per_beat = new_resolution;
+            state_update_tempo(&gs->state, gs->state.bpm);
+        }
+    }
+
+    // Read the LED rendering mode
+    if (gs->led_mode) {
+        bool hardware = *gs->led_mode > 0.5f;
+        if (hardware != gs->led_hardware) {
+            gs->led_hardware = hardware;
+            gs->grid_dirty = true;
+        }
+    }
+
+    // Read the scale and key; the row table is only rebuilt when they change
+    if (gs->scale || gs->key) {
+        const int scale = gs->scale ? (int)(*gs->scale) : gs->state.scale;
+        const int key = gs->key ? (int)(*gs->key) : gs->state.key;
+        if ((scale != gs->state.scale || key != gs->state.key) &&
+            state_set_scale(&gs->state, (uint8_t)scale, (uint8_t)key)) {
+            gs->grid_dirty = true;
+            gs->grid_change_counter++;
+            gs->follow.dirty = true;
+            rtlog_write(&gs->log, "grid-seq: Scale %d, key %d", scale, key);
+        }
+    }
+
+    // Read the keyboard follow mode and channel (1-16 on the port)
+    if (gs->follow_mode || gs->follow_channel) {
+        const int mode = gs->follow_mode ? (int)(*gs->follow_mode) : gs->follow.mode;
+        const int channel = gs->follow_channel ? (int)(*gs->follow_channel) - 1 : gs->follow.channel;
+        if (mode >= FOLLOW_OFF && mode <= FOLLOW_CHORD && channel >= 0 && channel < 16 &&
+            (mode != gs->follow.mode || channel != gs->follow.channel)) {
+            follow_configure(&gs->follow, (uint8_t)mode, (uint8_t)channel);
+            rtlog_write(&gs->log, "grid-seq: Keyboard follow mode %d on channel %d", mode, channel + 1);
+        }
+    }
+
+    // Read the MIDI thru filter
+    if (gs->thru_mode) {
+        const int mode = (int)(*gs->thru_mode);
+        gs->thru.mode = (uint8_t)(mode >= THRU_OFF && mode <= THRU_ALL ? mode : THRU_OFF);
+    }
+    if (gs->thru_channel) {
+        const int channel = (int)(*gs->thru_channel);
+        gs->thru.channel = (uint8_t)(channel >= 0 && channel <= 16 ? channel : 0);
+    }
+    gs->thru_count = 0;
+    gs->thru_next = 0;
+    gs->thru_bytes = 0;
+    uint32_t thru_dropped = 0;
+
+    // Read the clock source. Following MIDI clock starts stopped: the
+    // master's Start or Continue sets the transport going.
+    if (gs->clock_source) {
+        const bool slave = *gs->clock_source > 0.5f;
+        if (slave != gs->clock_slave) {
+            gs->clock_slave = slave;
+            clock_sync_reset(&gs->sync);
+            if (slave && gs->state.playing) stop_transport(gs);
+            rtlog_write(&gs->log, slave ? "grid-seq: Following MIDI clock on MIDI In"
+                                        : "grid-seq: Following the host transport");
+        }
+    }
+
+    // Read the MIDI clock output switch
+    if (gs->clock_out) {
+        midi_clock_enable(&gs->clock, &gs->state, *gs->clock_out > 0.5f);
+    }
+
+    // Read the Launchpad tiling
+    if (gs->launchpad_layout) {
+        int layout = (int)(*gs->launchpad_layout);
+        if (layout >= LP_LAYOUT_SINGLE && layout <= LP_LAYOUT_16X16 && layout != (int)gs->layout) {
+            set_layout(gs, (LpLayout)layout);
+        }
+    }
+
     // Process incoming MIDI and Time position
     LV2_ATOM_SEQUENCE_FOREACH(gs->midi_in, ev) {
         // Check for time position (tempo/BPM)
         if (ev->body.type == gs->atom_Object || ev->body.type == gs->atom_Blank) {
             const LV2_Atom_Object* obj = (const LV2_Atom_Object*)&ev->body;
 
-            if (obj->body.otype == gs->time_Position) {
+            if (obj->body.otype == gs->cellSet) {
+                handle_cell_set(gs, obj);
+            } else if (obj->body.otype == gs->rowLength) {
+                handle_row_length(gs, obj);
+            } else if (obj->body.otype == gs->ratchet) {
+                handle_ratchet(gs, obj);
+            } else if (obj->body.otype == gs->snapshotRequest) {
+                gs->snapshot_requested = true;
+            } else if (obj->body.otype == gs->time_Position && !gs->clock_slave) {
                 // Extract BPM
                 const LV2_Atom* bpm_atom = NULL;
                 const LV2_Atom* speed_atom = NULL;
+                const LV2_Atom* beat_atom = NULL;
 
                 lv2_atom_object_get(obj,
                     gs->time_beatsPerMinute, &bpm_atom,
                     gs->time_speed, &speed_atom,
+                    gs->time_beat, &beat_atom,
                     0);
 
                 // Update BPM
-                if (bpm_atom && bpm_atom->type == gs->map->map(gs->map->handle, LV2_ATOM__Float)) {
+                if (bpm_atom && bpm_atom->type == gs->atom_Float) {
                     float bpm = ((const LV2_Atom_Float*)bpm_atom)->body;
                     if (bpm > 0) {
                         state_update_tempo(&gs->state, bpm);
@@ -426,105 +1226,62 @@ static void run(LV2_Handle instance, uint32_t n_samples) {
                 }
 
                 // Update transport state (playing/stopped)
-                if (speed_atom && speed_atom->type == gs->map->map(gs->map->handle, LV2_ATOM__Float)) {
+                if (speed_atom && speed_atom->type == gs->atom_Float) {
                     float speed = ((const LV2_Atom_Float*)speed_atom)->body;
-                    bool was_playing = gs->state.playing;
-                    gs->state.playing = (speed > 0.0f);
-
-                    if (!was_playing && gs->state.playing) {
-                        // Started playing - reset frame counter
-                        gs->state.frame_counter = 0;
-                        gs->state.current_step = 0;
+                    bool playing = (speed > 0.0f);
+
+                    if (!gs->state.playing && playing) {
+                        // Started playing - reset frame counter. External
+                        // gear starts from the host's song position.
+                        double beat = 0.0;
+                        if (beat_atom && beat_atom->type == gs->atom_Double) {
+                            beat = ((const LV2_Atom_Double*)beat_atom)->body;
+                        } else if (beat_atom && beat_atom->type == gs->atom_Float) {
+                            beat = ((const LV2_Atom_Float*)beat_atom)->body;
+                        }
+                        start_transport(gs, 0, beat);
+                    } else if (gs->state.playing && !playing) {
+                        stop_transport(gs);
                     }
                 }
             }
         }
 
+        if (ev->body.type == gs->gridEdit && ev->body.size >= sizeof(GridEdit)) {
+            handle_grid_edit(gs, (const GridEdit*)(ev + 1));
+        }
+
+        if (ev->body.type == gs->generate && ev->body.size >= sizeof(GenRequest)) {
+            request_generate(gs, (const GenRequest*)(ev + 1));
+        }
+
+        // Keys on the follow channel play the pattern, Launchpad messages
+        // edit it, and what is left may pass through to midi_out
         if (ev->body.type == gs->midi_MidiEvent) {
             const uint8_t* msg = (const uint8_t*)(ev + 1);
-
-            // Note On (0x90)
-            if ((msg[0] & 0xF0) == 0x90 && msg[2] > 0) {
-                uint8_t note = msg[1];
-
-                // Check if it's a grid button
-                fprintf(stderr, "grid-seq: Received Note On - note=%d, checking if grid button\n", note);
-                if (note >= 11 && note <= 88) {
-                    uint8_t x, y;
-                    lp_note_to_grid(note, &x, &y);
-
-                    fprintf(stderr, "grid-seq: Launchpad pad pressed - MIDI note=%d -> grid x=%d y=%d\n",
-                            note, x, y);
-
-                    if (x < 8 && y < 8) {
-                        // Calculate actual grid position based on hardware page and pitch offset
-                        uint8_t actual_x = x + (gs->state.hardware_page * 8);
-                        uint8_t actual_y = y + gs->state.pitch_offset;
-                        if (actual_x < gs->state.sequence_length && actual_y < GRID_PITCH_RANGE) {
-                            fprintf(stderr, "  -> Toggling grid[%d][%d], page=%d, pitch_offset=%d, new_value=%d\n",
-                                    actual_x, actual_y, gs->state.hardware_page, gs->state.pitch_offset,
-                                    !gs->state.grid[actual_x][actual_y]);
-                            state_toggle_step(&gs->state, actual_x, actual_y);
-                            gs->grid_dirty = true;
-                            gs->grid_change_counter++;
-                            gs->last_toggled_x = actual_x;
-                            gs->last_toggled_y = actual_y;
-                        }
-                    }
+            ClockSyncAction action = CLOCK_SYNC_NONE;
+            if (gs->clock_slave &&
+                clock_sync_midi(&gs->sync, (uint32_t)ev->time.frames, msg, ev->body.size, &action)) {
+                handle_clock_action(gs, action);
+            } else if (!follow_midi(&gs->follow, msg, ev->body.size) &&
+                !handle_launchpad_midi(gs, 0, msg, ev->body.size) &&
+                thru_accept(&gs->thru, msg, ev->body.size)) {
+                if (gs->thru_count < THRU_MAX_EVENTS) {
+                    gs->thru_events[gs->thru_count++] = ev;
+                } else {
+                    thru_dropped++;
                 }
             }
-            // Control Change (0xB0) - for Launchpad arrow buttons
-            else if ((msg[0] & 0xF0) == 0xB0) {
-                uint8_t cc = msg[1];
-                uint8_t value = msg[2];
-
-                // Debug: Log ALL CC messages to discover arrow button CCs
-                static int cc_log_count = 0;
-                if (cc_log_count < 50 || (cc >= 80 && cc <= 100)) {  // Log first 50 or arrows range
-                    fprintf(stderr, "grid-seq: Launchpad CC received - CC=%d value=%d\n", cc, value);
-                    cc_log_count++;
-                }
+        }
+    }
 
-                // Handle arrow buttons and top row for sequence length
-                if (value > 0) {
-                    if (cc == 93) {  // Left arrow (CC 93)
-                        if (gs->state.hardware_page > 0) {
-                            gs->state.hardware_page--;
-                            gs->grid_dirty = true;
-                            fprintf(stderr, "grid-seq: Left arrow - switched to page 0 (steps 0-7)\n");
-                        }
-                    }
-                    else if (cc == 94) {  // Right arrow (CC 94)
-                        // Only switch to page 1 if sequence length > 8
-                        if (gs->state.sequence_length > 8 && gs->state.hardware_page == 0) {
-                            gs->state.hardware_page = 1;
-                            gs->grid_dirty = true;
-                            fprintf(stderr, "grid-seq: Right arrow - switched to page 1 (steps 8-15)\n");
-                        }
-                    }
-                    else if (cc == 91) {  // Shift pitch DOWN
-                        if (gs->state.pitch_offset > 0) {
-                            gs->state.pitch_offset--;
-                            gs->grid_dirty = true;
-                            fprintf(stderr, "grid-seq: Pitch shifted DOWN to %d (MIDI notes %d-%d)\n",
-                                    gs->state.pitch_offset,
-                                    gs->state.pitch_offset,
-                                    gs->state.pitch_offset + GRID_VISIBLE_ROWS - 1);
-                        }
-                    }
-                    else if (cc == 92) {  // Shift pitch UP
-                        if (gs->state.pitch_offset < (GRID_PITCH_RANGE - GRID_VISIBLE_ROWS)) {
-                            gs->state.pitch_offset++;
-                            gs->grid_dirty = true;
-                            fprintf(stderr, "grid-seq: Pitch shifted UP to %d (MIDI notes %d-%d)\n",
-                                    gs->state.pitch_offset,
-                                    gs->state.pitch_offset,
-                                    gs->state.pitch_offset + GRID_VISIBLE_ROWS - 1);
-                        }
-                    }
-                    // Top row buttons could be used for other functions if needed
-                    // CC 93/94 are arrows, so top row would be different CCs
-                }
+    // Pad presses from the other tiled Launchpads
+    for (uint8_t d = 1; d < lp_layout_devices(gs->layout); d++) {
+        if (!gs->devices[d].in) continue;
+
+        LV2_ATOM_SEQUENCE_FOREACH(gs->devices[d].in, ev) {
+            if (ev->body.type == gs->midi_MidiEvent) {
+                handle_launchpad_midi(gs, d, (const uint8_t*)(ev + 1), ev->body.size);
             }
         }
     }
@@ -535,64 +1292,22 @@ static void run(LV2_Handle instance, uint32_t n_samples) {
         float y = *gs->grid_y;
 
         // Check for device query signal (x == -200)
+        // Sent after the output buffers are set up, once it fits
         if (x == -200.0f && x != gs->prev_grid_x) {
-            fprintf(stderr, "\n=== DEVICE QUERY REQUESTED ===\n");
-
-            // Send Device Inquiry SysEx: F0 7E 7F 06 01 F7
-            uint8_t inquiry[] = {0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7};
-            fprintf(stderr, "Sending Universal Device Inquiry: ");
-            for (size_t i = 0; i < sizeof(inquiry); i++) {
-                fprintf(stderr, "%02X ", inquiry[i]);
-            }
-            fprintf(stderr, "\n");
-
-            lv2_atom_forge_frame_time(&gs->forge, 0);
-            lv2_atom_forge_atom(&gs->forge, sizeof(inquiry), gs->midi_MidiEvent);
-            lv2_atom_forge_write(&gs->forge, inquiry, sizeof(inquiry));
-
-            lv2_atom_forge_frame_time(&gs->launchpad_forge, 0);
-            lv2_atom_forge_atom(&gs->launchpad_forge, sizeof(inquiry), gs->midi_MidiEvent);
-            lv2_atom_forge_write(&gs->launchpad_forge, inquiry, sizeof(inquiry));
-
-            fprintf(stderr, "Sent to both outputs. Watch MIDI input for response.\n");
-            fprintf(stderr, "Expected response starts with: F0 7E 00 06 02...\n");
-            fprintf(stderr, "==============================\n\n");
-
+            rtlog_write(&gs->log, "grid-seq: Device query requested, sending Universal Device Inquiry");
+            gs->pending_inquiry = true;
             gs->prev_grid_x = x;
-            return;
         }
 
         // Check for hardware reset signal (x == -100)
         if (x == -100.0f && x != gs->prev_grid_x) {
-            fprintf(stderr, "\n=== HARDWARE RESET REQUESTED ===\n");
-            fprintf(stderr, "Querying Launchpad state...\n");
-
-            // Send Device Inquiry SysEx: F0 7E 7F 06 01 F7
-            uint8_t inquiry[] = {0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7};
-            lv2_atom_forge_frame_time(&gs->forge, 0);
-            lv2_atom_forge_atom(&gs->forge, sizeof(inquiry), gs->midi_MidiEvent);
-            lv2_atom_forge_write(&gs->forge, inquiry, sizeof(inquiry));
-            fprintf(stderr, "Sent Device Inquiry SysEx to main output\n");
-
-            // Force exit Programmer Mode first
-            fprintf(stderr, "Sending EXIT Programmer Mode...\n");
-            send_sysex_programmer_mode(gs, &gs->forge, false);
-            send_sysex_programmer_mode(gs, &gs->launchpad_forge, false);
-
-            // Wait a moment (flag will be reset so it re-enters on next run)
-            gs->launchpad_mode_entered = false;
-
-            fprintf(stderr, "Launchpad reset sequence initiated. Will re-enter Programmer Mode on next cycle.\n");
-            fprintf(stderr, "================================\n\n");
-
+            rtlog_write(&gs->log, "grid-seq: Hardware reset requested");
+            gs->pending_reset = true;
             gs->prev_grid_x = x;
-            return;
         }
 
         // Check for clear pattern signal (x == -300)
         if (x == -300.0f && x != gs->prev_grid_x) {
-            fprintf(stderr, "\n=== CLEAR PATTERN REQUESTED ===\n");
-
             // Clear all grid cells
             for (int i = 0; i < MAX_GRID_SIZE; i++) {
                 for (int j = 0; j < GRID_PITCH_RANGE; j++) {
@@ -604,29 +1319,23 @@ static void run(LV2_Handle instance, uint32_t n_samples) {
             gs->grid_dirty = true;
             gs->grid_change_counter++;
 
-            fprintf(stderr, "Pattern cleared. All grid cells set to false.\n");
-            fprintf(stderr, "================================\n\n");
+            rtlog_write(&gs->log, "grid-seq: Pattern cleared");
 
             gs->prev_grid_x = x;
-            return;
         }
 
         // Check for re-center signal (x == -400)
         if (x == -400.0f && x != gs->prev_grid_x) {
-            fprintf(stderr, "\n=== RE-CENTER PITCH REQUESTED ===\n");
-
             // Reset pitch offset to default (C2 = MIDI 36)
             gs->state.pitch_offset = DEFAULT_PITCH_OFFSET;
             gs->grid_dirty = true;
 
-            fprintf(stderr, "Pitch offset reset to %d (MIDI notes %d-%d)\n",
-                    DEFAULT_PITCH_OFFSET,
-                    DEFAULT_PITCH_OFFSET,
-                    DEFAULT_PITCH_OFFSET + GRID_VISIBLE_ROWS - 1);
-            fprintf(stderr, "================================\n\n");
+            rtlog_write(&gs->log, "grid-seq: Pitch offset re-centered to %d (MIDI notes %d-%d)",
+                        DEFAULT_PITCH_OFFSET,
+                        DEFAULT_PITCH_OFFSET,
+                        DEFAULT_PITCH_OFFSET + GRID_VISIBLE_ROWS - 1);
 
             gs->prev_grid_x = x;
-            return;
         }
 
         // If values changed and are valid, toggle the grid cell
@@ -635,33 +1344,75 @@ static void run(LV2_Handle instance, uint32_t n_samples) {
             x >= 0 && x < MAX_GRID_SIZE && y >= 0 && y < GRID_VISIBLE_ROWS) {
             uint8_t absolute_note = gs->state.pitch_offset + (uint8_t)y;
             if (absolute_note < GRID_PITCH_RANGE) {
-                fprintf(stderr, "grid-seq: Plugin toggling cell [%d,%d] (window row %d + offset %d = MIDI note %d), new value: %d\n",
-                        (int)x, absolute_note, (int)y, gs->state.pitch_offset, absolute_note,
-                        !gs->state.grid[(int)x][absolute_note]);
+                rtlog_write(&gs->log, "grid-seq: UI toggling cell [%d,%d] (window row %d), new value: %d",
+                            (int)x, absolute_note, (int)y, !gs->state.grid[(int)x][absolute_note]);
                 state_toggle_step(&gs->state, (uint8_t)x, absolute_note);
 
                 gs->prev_grid_x = x;
                 gs->prev_grid_y = y;
                 gs->grid_dirty = true;
                 gs->grid_change_counter++;
-                fprintf(stderr, "grid-seq: Set grid_dirty=true after toggle\n");
-                gs->last_toggled_x = (int8_t)x;
-                gs->last_toggled_y = absolute_note;
             }
         }
     }
 
+    // Under MIDI clock the sequencer moves as far as the master's ticks
+    // put it, otherwise one frame per sample
+    const uint32_t advance = gs->clock_slave ? follow_clock(gs, n_samples) : n_samples;
+    clock_sync_advance(&gs->sync, n_samples);
+
+    // Advance the transport first, so the space needed for this block's
+    // notes is known before anything else is written to midi_out. Only
+    // send Note Offs if MIDI filter is disabled.
+    const bool filter_enabled = (gs->midi_filter && *gs->midi_filter > 0.5f);
+    SeqBlock block;
+    sequencer_begin_block(&gs->state, advance, n_samples, !filter_enabled, gs->freewheeling, &block);
+    begin_step(gs, block.play_step);
+
+    // Ratchet hits of a new step are queued at the frame the step plays
+    // on (offset 0, as for its other notes); the block plays whatever in
+    // the queue falls inside it
+    uint32_t notes_dropped = 0;
+    if (block.play_step) {
+        notes_dropped += sequencer_schedule_ratchets(&gs->state, &gs->queue, block.start, !filter_enabled);
+    }
+
+    // Bytes reserved on midi_out for Note Ons and Note Offs
+    uint32_t step_notes = block.play_step ? sequencer_step_note_count(&gs->state, gs->state.current_step) : 0;
+    uint32_t note_events = step_notes;
+    if (block.note_offs) {
+        note_events += sequencer_active_note_count(&gs->state) + step_notes;
+    }
+    if (block.by_points) {
+        note_events += points_note_count(gs, &block);
+    }
+    note_events += gs->state.playing ? sequencer_queue_due(&gs->queue, block.end) : gs->queue.count;
+
+    // Clock ticks up to where the sequencer's clock now stands (or will,
+    // point by point), at their exact frames, with Start/Stop/Continue
+    // ahead of them
+    const uint64_t transport_end = block.by_points ? block.until : gs->state.frame_counter;
+    gs->clock_end = gs->state.playing ? transport_end : block.start;
+    midi_clock_seek(&gs->clock, &gs->state, block.start);
+    note_events += midi_clock_due(&gs->clock, &gs->state, gs->clock_end);
+    const uint32_t note_reserve = note_events * sequencer_midi_event_size(3);
+
     // Setup forge for MIDI notes output
     const uint32_t out_capacity = gs->midi_out->atom.size;
     lv2_atom_forge_set_buffer(&gs->forge,
                               (uint8_t*)gs->midi_out,
                               out_capacity);
 
-    // Setup forge for Launchpad control output
-    const uint32_t lp_capacity = gs->launchpad_out->atom.size;
-    lv2_atom_forge_set_buffer(&gs->launchpad_forge,
-                              (uint8_t*)gs->launchpad_out,
-                              lp_capacity);
+    // Setup forges for Launchpad control outputs (every connected port gets
+    // a valid sequence, also for devices the current layout does not use)
+    uint32_t lp_capacity[LP_MAX_DEVICES];
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        LaunchpadDevice* dev = &gs->devices[d];
+        if (!dev->out) continue;
+
+        lp_capacity[d] = dev->out->atom.size;
+        lv2_atom_forge_set_buffer(&dev->forge, (uint8_t*)dev->out, lp_capacity[d]);
+    }
 
     // Setup forge for UI notifications
     const uint32_t notify_capacity = gs->notify->atom.size;
@@ -678,100 +1429,339 @@ static void run(LV2_Handle instance, uint32_t n_samples) {
     }
 
     // Update grid row ports with current state
-    update_grid_row_ports(gs);
+    if (!gs->freewheeling) {
+        update_grid_row_ports(gs);
+    }
 
     // Start MIDI note sequence
     LV2_Atom_Forge_Frame frame;
     lv2_atom_forge_sequence_head(&gs->forge, &frame, 0);
 
-    // Start Launchpad control sequence
-    LV2_Atom_Forge_Frame lp_frame;
-    lv2_atom_forge_sequence_head(&gs->launchpad_forge, &lp_frame, 0);
+    // Start Launchpad control sequences
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        if (gs->devices[d].out) {
+            lv2_atom_forge_sequence_head(&gs->devices[d].forge, &gs->devices[d].frame, 0);
+        }
+    }
+    const uint8_t num_devices = lp_layout_devices(gs->layout);
+    LV2_Atom_Forge* lp_forge = &gs->devices[0].forge;
 
     // Start UI notification sequence (use frame time like MIDI and Launchpad)
     LV2_Atom_Forge_Frame notify_frame;
     lv2_atom_forge_sequence_head(&gs->notify_forge, &notify_frame, 0);
 
-    // Enter Programmer Mode on first run
-    // IMPORTANT: Send to BOTH midi_out and launchpad_out to ensure it reaches the device
-    if (!gs->launchpad_mode_entered) {
-        send_sysex_programmer_mode(gs, &gs->forge, true);  // Main MIDI output
-        send_sysex_programmer_mode(gs, &gs->launchpad_forge, true);  // Launchpad output
-        gs->launchpad_mode_entered = true;
-        gs->grid_dirty = true;
-        fprintf(stderr, "grid-seq: Sent Programmer Mode SysEx to both outputs\n");
+    // Control messages go out at frame 0 ahead of the notes, but only into
+    // the space the notes leave free. Requests that do not fit wait for a
+    // later block, as do all of them while freewheeling.
+    const uint32_t inquiry_bytes = sequencer_midi_event_size(INQUIRY_SYSEX_SIZE);
+    const uint32_t sysex_bytes = sequencer_midi_event_size(PROGRAMMER_SYSEX_SIZE);
+    bool reset_sent = false;
+
+    if (gs->pending_reset && !gs->freewheeling) {
+        bool fits = control_fits(&gs->forge, inquiry_bytes + 2 * sysex_bytes, note_reserve);
+        for (uint8_t d = 0; d < num_devices; d++) {
+            if (gs->devices[d].out) {
+                fits = fits && control_fits(&gs->devices[d].forge, sysex_bytes, 0);
+            }
+        }
+
+        if (fits) {
+            send_inquiry(gs, &gs->forge);
+
+            // Force exit Programmer Mode first
+            send_sysex_programmer_mode(gs, &gs->forge, false);
+            for (uint8_t d = 0; d < num_devices; d++) {
+                if (!gs->devices[d].out) continue;
+
+                send_sysex_programmer_mode(gs, &gs->devices[d].forge, false);
+                leds_bucket_take(&gs->devices[d].link, LP_PACKETS(PROGRAMMER_SYSEX_SIZE));
+
+                // Wait a moment (flag will be reset so it re-enters on next run)
+                gs->devices[d].mode_entered = false;
+            }
+            gs->pending_reset = false;
+            reset_sent = true;
+
+            rtlog_write(&gs->log, "grid-seq: Reset sent, re-entering Programmer Mode on next cycle");
+        } else {
+            perf_record_overflow(&gs->perf, PERF_PORT_MIDI_OUT, 1);
+        }
     }
 
-    // Calculate step position before advancing
-    uint64_t old_frame = gs->state.frame_counter;
-    uint64_t old_step_frame = old_frame % gs->state.frames_per_step;
-    bool was_before_half = old_step_frame < (gs->state.frames_per_step / 2);
+    if (gs->pending_inquiry && !gs->freewheeling) {
+        if (control_fits(&gs->forge, inquiry_bytes, note_reserve) &&
+            control_fits(lp_forge, inquiry_bytes, 0)) {
+            send_inquiry(gs, &gs->forge);
+            send_inquiry(gs, lp_forge);
+            leds_bucket_take(&gs->devices[0].link, LP_PACKETS(INQUIRY_SYSEX_SIZE));
+            gs->pending_inquiry = false;
 
-    // Always trigger first step on first run
-    if (gs->state.first_run) {
-        sequencer_process_step(&gs->state, &gs->forge, &gs->seq_uris, 0);
-        gs->state.first_run = false;
+            // Asked for by hand: the answer re-initialises the device
+            gs->devices[0].present = false;
+
+            rtlog_write(&gs->log, "grid-seq: Sent to both outputs, expect a reply starting F0 7E 00 06 02");
+        } else {
+            perf_record_overflow(&gs->perf, PERF_PORT_MIDI_OUT, 1);
+        }
+    }
+
+    // Enter Programmer Mode on first run, and on each device the layout adds
+    // IMPORTANT: For the first device send to BOTH midi_out and launchpad_out
+    // to ensure it reaches the device
+    for (uint8_t d = 0; d < num_devices && !reset_sent && !gs->freewheeling; d++) {
+        LaunchpadDevice* dev = &gs->devices[d];
+        if (dev->mode_entered || !dev->out) continue;
+
+        if (control_fits(&dev->forge, sysex_bytes, 0)) {
+            if (d == 0) {
+                // The midi_out copy is dropped rather than displace notes
+                if (control_fits(&gs->forge, sysex_bytes, note_reserve)) {
+                    send_sysex_programmer_mode(gs, &gs->forge, true);  // Main MIDI output
+                } else {
+                    perf_record_overflow(&gs->perf, PERF_PORT_MIDI_OUT, 1);
+                }
+            }
+            send_sysex_programmer_mode(gs, &dev->forge, true);  // Launchpad output
+            leds_bucket_take(&dev->link, LP_PACKETS(PROGRAMMER_SYSEX_SIZE));
+            dev->mode_entered = true;
+            dev->present = true;
+            dev->probing = false;
+            gs->grid_dirty = true;
+            leds_invalidate(&dev->leds);
+            rtlog_write(&gs->log, "grid-seq: Launchpad %d in Programmer Mode", d + 1);
+        } else {
+            perf_record_overflow(&gs->perf, PERF_PORT_LAUNCHPAD_OUT, 1);
+        }
+    }
+
+    // Presence probes: a Device Inquiry to every Launchpad each
+    // LP_PROBE_INTERVAL seconds, on its own output only. A device that
+    // let a probe go unanswered counts as unplugged, so its next reply
+    // (see handle_launchpad_midi()) re-initialises it.
+    gs->probe_elapsed += n_samples;
+    if (gs->probe_elapsed >= LP_PROBE_INTERVAL * gs->state.sample_rate && !gs->freewheeling) {
+        gs->probe_elapsed = 0;
+        for (uint8_t d = 0; d < num_devices; d++) {
+            LaunchpadDevice* dev = &gs->devices[d];
+            if (!dev->out || !dev->mode_entered) continue;
+
+            if (!control_fits(&dev->forge, inquiry_bytes, 0)) {
+                perf_record_overflow(&gs->perf, PERF_PORT_LAUNCHPAD_OUT, 1);
+                continue;
+            }
+            if (dev->probing && dev->present) {
+                dev->present = false;
+                rtlog_write(&gs->log, "grid-seq: Launchpad %d not answering", d + 1);
+            }
+            send_inquiry(gs, &dev->forge);
+            leds_bucket_take(&dev->link, LP_PACKETS(INQUIRY_SYSEX_SIZE));
+            dev->probing = true;
+        }
+    }
+
+    const uint32_t notes_start = gs->forge.offset;
+    notes_dropped += midi_clock_write_cue(&gs->clock, &gs->forge, &gs->seq_uris, 0);
+    while (next_clock_frame(gs) == block.start) {
+        if (!midi_clock_write_tick(&gs->clock, &gs->state, &gs->forge, &gs->seq_uris, block.start)) {
+            notes_dropped++;
+        }
     }
-    // Check if we crossed a step boundary
-    else if (sequencer_advance(&gs->state, n_samples)) {
-        sequencer_process_step(&gs->state, &gs->forge, &gs->seq_uris, 0);
-        gs->grid_dirty = true;  // Update LEDs when step changes
+    if (block.play_step) {
+        notes_dropped += sequencer_process_step(&gs->state, &gs->forge, &gs->seq_uris, 0);
     }
 
-    // Check if we crossed the 50% point (for Note Off)
-    uint64_t new_frame = gs->state.frame_counter;
-    uint64_t new_step_frame = new_frame % gs->state.frames_per_step;
-    bool is_after_half = new_step_frame >= (gs->state.frames_per_step / 2);
+    if (block.note_offs) {
+        const uint32_t offset = (uint32_t)(block.half_point - block.start);
+
+        // Queued and thru events before it first, keeping the sequence in
+        // time order
+        notes_dropped += merge_events(gs, block.start, block.half_point, notes_start, note_reserve, &thru_dropped);
+        notes_dropped += sequencer_process_queue(&gs->queue, &gs->forge, &gs->seq_uris,
+                                                 block.start, block.half_point);
+        notes_dropped += sequencer_process_note_offs(&gs->state, &gs->forge, &gs->seq_uris, offset);
+    }
 
-    if (was_before_half && is_after_half) {
-        // Calculate frame offset to the 50% point
-        uint64_t half_point = (gs->state.frame_counter / gs->state.frames_per_step) * gs->state.frames_per_step
-                             + (gs->state.frames_per_step / 2);
-        uint32_t offset = (uint32_t)(half_point - old_frame);
+    // A long block (or any block while freewheeling) plays every step and
+    // Note Off point it holds in one pass, each at its exact frame
+    SeqPoint point;
+    while (block.by_points && sequencer_next_point(&gs->state, &block, &point)) {
+        notes_dropped += merge_events(gs, block.start, point.frame, notes_start, note_reserve, &thru_dropped);
+        notes_dropped += sequencer_process_queue(&gs->queue, &gs->forge, &gs->seq_uris,
+                                                 block.start, point.frame);
+        if (point.step) {
+            begin_step(gs, true);
+            notes_dropped += sequencer_schedule_ratchets(&gs->state, &gs->queue, point.frame, !filter_enabled);
+            notes_dropped += sequencer_process_step(&gs->state, &gs->forge, &gs->seq_uris, point.offset);
+        } else if (!filter_enabled) {
+            notes_dropped += sequencer_process_note_offs(&gs->state, &gs->forge, &gs->seq_uris, point.offset);
+        }
+    }
 
-        // Only send Note Offs if MIDI filter is disabled
-        bool filter_enabled = (gs->midi_filter && *gs->midi_filter > 0.5f);
-        if (!filter_enabled) {
-            sequencer_process_note_offs(&gs->state, &gs->forge, &gs->seq_uris, offset);
+    if (gs->state.playing) {
+        notes_dropped += merge_events(gs, block.start, block.end, notes_start, note_reserve, &thru_dropped);
+        notes_dropped += sequencer_process_queue(&gs->queue, &gs->forge, &gs->seq_uris,
+                                                 block.start, block.end);
+    } else {
+        // Stopped: no ratchet note may be left hanging
+        if (gs->queue.count) {
+            notes_dropped += sequencer_queue_release(&gs->queue, &gs->forge, &gs->seq_uris, 0);
         }
+        merge_events(gs, block.start, UINT64_MAX, notes_start, note_reserve, &thru_dropped);
+    }
+
+    if (notes_dropped + thru_dropped) {
+        perf_record_overflow(&gs->perf, PERF_PORT_MIDI_OUT, notes_dropped + thru_dropped);
     }
 
     // End MIDI note sequence
     lv2_atom_forge_pop(&gs->forge, &frame);
 
-    // Update Launchpad LEDs if grid changed or step changed
-    if (gs->grid_dirty || gs->state.current_step != gs->prev_led_step) {
-        fprintf(stderr, "grid-seq: Calling update_launchpad_leds (grid_dirty=%d, step=%d)\n",
-                gs->grid_dirty, gs->state.current_step);
-        update_launchpad_leds(gs, &gs->launchpad_forge);
+    // Nothing goes to the Launchpads or the UI while freewheeling: the
+    // LEDs, the snapshot and the counters catch up once the host is back
+    // in real time
+    const bool ui_traffic = !gs->freewheeling;
+
+    // Update Launchpad LED targets if grid changed or step changed
+    if (ui_traffic && (gs->grid_dirty || gs->state.current_step != gs->prev_led_step)) {
+        update_launchpad_leds(gs);
         gs->grid_dirty = false;
         gs->prev_led_step = gs->state.current_step;
     }
 
-    // Send full grid state to UI if anything changed
-    if (gs->last_toggled_x >= 0 && gs->last_toggled_y >= 0) {
-        // Prepare grid data
-        uint8_t grid_data[64];
-        for (int x = 0; x < 8; x++) {
-            for (int y = 0; y < 8; y++) {
-                grid_data[x * 8 + y] = gs->state.grid[x][y] ? 1 : 0;
-            }
+    // Send the LEDs that differ from each device. Every device has its own
+    // link bucket, so one busy device cannot flood its link or starve the
+    // others; LEDs over budget or without buffer space wait for later blocks.
+    for (uint8_t d = 0; d < num_devices && ui_traffic; d++) {
+        LaunchpadDevice* dev = &gs->devices[d];
+        if (!dev->out) continue;
+
+        leds_bucket_refill(&dev->link, n_samples, gs->state.sample_rate);
+        if (!dev->mode_entered) continue;
+
+        uint32_t budget = leds_bucket_available(&dev->link);
+        const uint32_t granted = budget;
+        uint32_t leds_deferred = leds_flush(&dev->leds, &dev->forge, &gs->seq_uris, &budget);
+        leds_bucket_take(&dev->link, granted - budget);
+        if (leds_deferred) {
+            perf_record_overflow(&gs->perf, PERF_PORT_LAUNCHPAD_OUT, leds_deferred);
         }
+    }
 
-        // Write using frame_time (frames, not beats) to match working MIDI pattern
-        lv2_atom_forge_frame_time(&gs->notify_forge, 0);
-        lv2_atom_forge_atom(&gs->notify_forge, 64, gs->gridState);
-        lv2_atom_forge_write(&gs->notify_forge, grid_data, 64);
+    // Send a full grid snapshot to the UI when it asked for one, or when
+    // the grid or the Launchpad view changed. Without space the snapshot
+    // stays pending for the next block.
+    if (ui_traffic &&
+        (gs->snapshot_requested ||
+         gs->snapshot_changes != gs->grid_change_counter ||
+         gs->snapshot_offset != gs->state.pitch_offset ||
+         gs->snapshot_length != gs->state.sequence_length)) {
+        GridSnapshot snapshot;
+        state_pack_snapshot(&gs->state, &snapshot);
+
+        if (gs->notify_forge.offset + sequencer_midi_event_size(sizeof(snapshot)) <= gs->notify_forge.size) {
+            lv2_atom_forge_frame_time(&gs->notify_forge, 0);
+            lv2_atom_forge_atom(&gs->notify_forge, sizeof(snapshot), gs->gridState);
+            lv2_atom_forge_write(&gs->notify_forge, &snapshot, sizeof(snapshot));
+
+            gs->snapshot_requested = false;
+            gs->snapshot_changes = gs->grid_change_counter;
+            gs->snapshot_offset = gs->state.pitch_offset;
+            gs->snapshot_length = gs->state.sequence_length;
+        } else {
+            perf_record_overflow(&gs->perf, PERF_PORT_NOTIFY, 1);
+        }
+    }
 
-        gs->last_toggled_x = -1;
-        gs->last_toggled_y = -1;
+    // End Launchpad control sequences
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        if (gs->devices[d].out) {
+            lv2_atom_forge_pop(&gs->devices[d].forge, &gs->devices[d].frame);
+        }
     }
 
-    // End Launchpad control sequence
-    lv2_atom_forge_pop(&gs->launchpad_forge, &lp_frame);
+    // Publish performance counters every PERF_PUBLISH_INTERVAL seconds
+    uint32_t log_dropped = rtlog_dropped_total(&gs->log);
+    perf_record_log_dropped(&gs->perf, log_dropped - gs->log_dropped_seen);
+    gs->log_dropped_seen = log_dropped;
+
+    if (ui_traffic && perf_publish_due(&gs->perf) &&
+        perf_write(&gs->perf, &gs->notify_forge, &gs->perf_uris, gs->state.sample_rate, 0)) {
+        perf_reset(&gs->perf);
+    }
 
     // End UI notification sequence
     lv2_atom_forge_pop(&gs->notify_forge, &notify_frame);
+
+    // Hand queued diagnostics to the worker thread for printing
+    if (gs->schedule && !gs->log_scheduled && rtlog_pending(&gs->log)) {
+        const uint32_t msg = WORK_DRAIN_LOG;
+        if (gs->schedule->schedule_work(gs->schedule->handle, sizeof(msg), &msg) == LV2_WORKER_SUCCESS) {
+            gs->log_scheduled = true;
+        }
+    }
+
+    record_port(gs, PERF_PORT_MIDI_OUT, gs->midi_out, out_capacity);
+    for (uint8_t d = 0; d < LP_MAX_DEVICES; d++) {
+        if (gs->devices[d].out) {
+            record_port(gs, PERF_PORT_LAUNCHPAD_OUT, gs->devices[d].out, lp_capacity[d]);
+        }
+    }
+    record_port(gs, PERF_PORT_NOTIFY, gs->notify, notify_capacity);
+    perf_record_block(&gs->perf, n_samples, perf_now_ns() - run_start, block.steps);
+}
+
+static LV2_Worker_Status work(
+    LV2_Handle instance,
+    LV2_Worker_Respond_Function respond,
+    LV2_Worker_Respond_Handle handle,
+    uint32_t size,
+    const void* data
+) {
+    GridSeq* gs = (GridSeq*)instance;
+
+    if (size == sizeof(GenerateWork) && *(const uint32_t*)data == WORK_GENERATE) {
+        GenerateWork work;
+        memcpy(&work, data, sizeof(work));
+        if (!generator_run(&work.request, &work.pattern)) {
+            return LV2_WORKER_ERR_UNKNOWN;
+        }
+        return respond(handle, sizeof(work), &work);
+    }
+
+    if (size != sizeof(uint32_t) || *(const uint32_t*)data != WORK_DRAIN_LOG) {
+        return LV2_WORKER_ERR_UNKNOWN;
+    }
+
+    rtlog_drain(&gs->log, stderr);
+
+    // Tell run() the drain is done so it can schedule the next one
+    const uint32_t msg = WORK_DRAIN_LOG;
+    return respond(handle, sizeof(msg), &msg);
+}
+
+static LV2_Worker_Status work_response(LV2_Handle instance, uint32_t size, const void* data) {
+    GridSeq* gs = (GridSeq*)instance;
+
+    // A generated pattern waits for run() to swap it in at the next bar.
+    // With one already waiting, the new area joins it.
+    if (size == sizeof(GenerateWork) && *(const uint32_t*)data == WORK_GENERATE) {
+        const GenerateWork* work = (const GenerateWork*)data;
+        if (!gs->pattern_pending) {
+            memset(&gs->next_mask, 0, sizeof(gs->next_mask));
+            gs->pattern_pending = true;
+        }
+
+        GenPattern area;
+        memset(&area, 0, sizeof(area));
+        generator_mark(&area, &work->request);
+        generator_overlay(&gs->next_pattern, &work->pattern, &area);
+        generator_mark(&gs->next_mask, &work->request);
+        gs->grid_dirty = true;  // Show the queued cells
+        return LV2_WORKER_SUCCESS;
+    }
+
+    gs->log_scheduled = false;
+    return LV2_WORKER_SUCCESS;
 }
 
 static void deactivate(LV2_Handle instance) {
@@ -783,6 +1773,15 @@ static void cleanup(LV2_Handle instance) {
     free(instance);
 }
 
+static const void* extension_data(const char* uri) {
+    static const LV2_Worker_Interface worker = {work, work_response, NULL};
+
+    if (strcmp(uri, LV2_WORKER__interface) == 0) {
+        return &worker;
+    }
+    return NULL;
+}
+
 static const LV2_Descriptor descriptor = {
     .URI = PLUGIN_URI,
     .instantiate = instantiate,
@@ -791,7 +1790,7 @@ static const LV2_Descriptor descriptor = {
     .run = run,
     .deactivate = deactivate,
     .cleanup = cleanup,
-    .extension_data = NULL
+    .extension_data = extension_data
 };
 
 LV2_SYMBOL_EXPORT
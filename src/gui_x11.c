@@ -10,10 +10,14 @@
  * WARRANTIES WITH REGARD TO THIS SOFTWARE.
  */
 
-// Raw X11 + Cairo UI implementation for proper event handling in Reaper
+
+// Cairo UI on the bundled pugl: pugl owns the window and the event loop,
+// Cairo draws into a GL canvas (gl_canvas.c) that is redrawn only where
+// damaged
 
 #include "grid_seq/common.h"
 #include "state.h"
+#include "pugl/pugl.h"
 
 #include <lv2/core/lv2.h>
 #include <lv2/ui/ui.h>
@@ -21,45 +25,125 @@
 #include <lv2/atom/atom.h>
 #include <lv2/atom/forge.h>
 #include <lv2/midi/midi.h>
+#include <lv2/options/options.h>
 
-#include <X11/Xlib.h>
-#include <X11/Xutil.h>
+// Xlib defines Bool, a member name in the LV2 forge: include it after LV2
+#include <GL/glx.h>
 #include <cairo/cairo.h>
-#include <cairo/cairo-xlib.h>
 
+#include "gl_canvas.h"
+
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 #define UI_URI PLUGIN_URI "#ui"
+
+// Window size in logical units; pixels are these times the HiDPI scale
 #define WINDOW_WIDTH 640
 #define WINDOW_HEIGHT 480
+#define WINDOW_MIN_WIDTH 400
+#define WINDOW_MIN_HEIGHT 300
 #define GRID_MARGIN 20
-#define GRID_SPACING 2
+
+// Piano roll: the whole 0-127 range, scrolled and zoomed vertically
+#define KEY_GUTTER 36
+#define BUTTON_COLUMN 50
+#define ROW_HEIGHT_MIN 6
+#define ROW_HEIGHT_MAX 40
+#define ROW_HEIGHT_DEFAULT 14
+#define SCROLL_ROWS 3
+
+// Button column on the right
+#define BUTTON_SIZE 30
+#define BUTTON_SPACING 5
+
+// Settings panel, drawn over the roll while open
+#define DIALOG_WIDTH 360
+#define DIALOG_HEIGHT 220
+
+typedef struct {
+    int left;       // Grid area, right of the keyboard gutter
+    int top;
+    int width;
+    int height;
+    int cell_width;
+} RollGeometry;
+
+// Positions derived from the window size and the sequence length. Only
+// recomputed when one of those changes, not per frame or per click.
+typedef struct {
+    int width;      // Window size in logical units
+    int height;
+    RollGeometry roll;
+    int buttons_x;
+    int dialog_x;
+    int dialog_y;
+} Layout;
+
+typedef enum {
+    DRAG_NONE,
+    DRAG_PAINT,     // Setting every cell crossed to paint_value
+    DRAG_SELECT     // Rubber band
+} DragMode;
+
+// Cells from step0 to step1 and note0 to note1, inclusive
+typedef struct {
+    bool active;
+    int step0, step1;
+    int note0, note1;
+} Selection;
 
 typedef struct {
-    Display* display;
-    Window window;
-    Window settings_window;
-    Visual* visual;
-    int screen;
-    cairo_surface_t* surface;
-    cairo_surface_t* settings_surface;
+    PuglView* view;
+    GlCanvas* canvas;
+    bool presenter_chosen;      // GL or back buffer, decided at first display
+    double scale;               // Pixels per logical unit
+    Layout layout;
+    int requested_width;        // Pixels, applied by the pugl resize callback
+    int requested_height;
+    const LV2UI_Resize* host_resize;
 
     LV2UI_Write_Function write_function;
     LV2UI_Controller controller;
 
     GridSeqState state;
 
-    int cell_size;
-    bool needs_redraw;
+    // Piano roll view: view_top is the pitch at the top edge, in rows
+    // (note n covers pitches n to n + 1)
+    double view_top;
+    int row_height;
+    bool view_placed;     // Centered on the Launchpad view once
+
     bool settings_open;
 
+    // Editing. Each gesture or key is sent as one gridEdit; edits not yet
+    // confirmed by a snapshot are drawn over the grid from pending.
+    GridEdit pending;
+    bool has_pending;
+    GridEdit stroke;            // Cells of the paint drag in progress
+    DragMode drag;
+    bool paint_value;
+    int anchor_step;            // Where the rubber band started
+    int anchor_note;
+    Selection selection;
+    int hover_step;             // Cell under the pointer, -1 outside
+    int hover_note;
+
+    uint32_t gen_seed;          // Advanced for each random or mutate request
+
+    // Copied cells, relative to the copied area's first step and lowest note
+    bool clipboard[MAX_GRID_SIZE][GRID_PITCH_RANGE];
+    int clip_steps;             // 0 when empty
+    int clip_notes;
+
     // Settings values
     uint8_t pending_length;
     bool pending_filter;
@@ -70,61 +154,250 @@ typedef struct {
 
     // URIDs for atom forge
     LV2_URID midi_MidiEvent;
+    LV2_URID atom_eventTransfer;
+    LV2_URID gridState;
+    LV2_URID snapshotRequest;
+    LV2_URID gridEdit;
+    LV2_URID rowLength;
+    LV2_URID ratchet;
+    LV2_URID generate;
+    LV2_URID cellX;
+    LV2_URID cellY;
+    LV2_URID cellValue;
     LV2_Atom_Forge forge;
 } GridSeqX11UI;
 
-static void draw_grid(GridSeqX11UI* ui) {
-    if (!ui->surface) return;
+static void update_layout(GridSeqX11UI* ui) {
+    Layout* layout = &ui->layout;
+    RollGeometry* geom = &layout->roll;
 
-    cairo_t* cr = cairo_create(ui->surface);
+    geom->left = GRID_MARGIN + KEY_GUTTER;
+    geom->top = GRID_MARGIN;
+    geom->width = layout->width - BUTTON_COLUMN - geom->left;
+    geom->height = layout->height - 2 * GRID_MARGIN;
+    geom->cell_width = geom->width / ui->state.sequence_length;
 
-    // Clear background
-    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
-    cairo_paint(cr);
+    layout->buttons_x = layout->width - BUTTON_SIZE - 10;
+    layout->dialog_x = (layout->width - DIALOG_WIDTH) / 2;
+    layout->dialog_y = (layout->height - DIALOG_HEIGHT) / 2;
+}
 
-    // Calculate cell size based on sequence length
-    int visible_cols = ui->state.sequence_length;
-    int available_width = WINDOW_WIDTH - 2 * GRID_MARGIN;
-    int available_height = WINDOW_HEIGHT - 2 * GRID_MARGIN;
-
-    int cell_width = (available_width - (visible_cols - 1) * GRID_SPACING) / visible_cols;
-    int cell_height = (available_height - (GRID_VISIBLE_ROWS - 1) * GRID_SPACING) / GRID_VISIBLE_ROWS;
-    ui->cell_size = (cell_width < cell_height) ? cell_width : cell_height;
-
-    // Draw grid cells
-    for (int x = 0; x < visible_cols; x++) {
-        for (int y = 0; y < GRID_VISIBLE_ROWS; y++) {
-            int px = GRID_MARGIN + x * (ui->cell_size + GRID_SPACING);
-            int py = GRID_MARGIN + y * (ui->cell_size + GRID_SPACING);
-
-            // Flip Y coordinate for display
-            int grid_y = GRID_VISIBLE_ROWS - 1 - y;
-            bool active = ui->state.grid[x][grid_y];
-
-            // Highlight current step
-            if (x == ui->state.current_step) {
-                cairo_set_source_rgb(cr, 0.3, 0.3, 0.5);
-            } else if (active) {
-                cairo_set_source_rgb(cr, 0.8, 0.8, 0.2);
-            } else {
-                cairo_set_source_rgb(cr, 0.2, 0.2, 0.2);
-            }
+// Schedule a redraw of an area, in logical units
+static void invalidate(GridSeqX11UI* ui, double x, double y, double width, double height) {
+    canvas_damage(ui->canvas, x, y, width, height);
+    if (ui->view) puglPostRedisplay(ui->view);
+}
+
+static void invalidate_all(GridSeqX11UI* ui) {
+    invalidate(ui, 0, 0, ui->layout.width, ui->layout.height);
+}
+
+static void invalidate_step(GridSeqX11UI* ui, int step) {
+    const RollGeometry* geom = &ui->layout.roll;
+    invalidate(ui, geom->left + step * geom->cell_width - 1, geom->top,
+               geom->cell_width + 2, geom->height);
+}
+
+static void invalidate_dialog(GridSeqX11UI* ui) {
+    invalidate(ui, ui->layout.dialog_x - 2, ui->layout.dialog_y - 2,
+               DIALOG_WIDTH + 4, DIALOG_HEIGHT + 4);
+}
 
-            cairo_rectangle(cr, px, py, ui->cell_size, ui->cell_size);
+static void invalidate_roll(GridSeqX11UI* ui) {
+    const RollGeometry* geom = &ui->layout.roll;
+    invalidate(ui, geom->left, geom->top, geom->width, geom->height);
+}
+
+static double roll_visible_rows(const GridSeqX11UI* ui) {
+    return (double)ui->layout.roll.height / ui->row_height;
+}
+// Keep the view inside 0-127
+static void clamp_view(GridSeqX11UI* ui) {
+    double rows = roll_visible_rows(ui);
+    if (ui->view_top > GRID_PITCH_RANGE) ui->view_top = GRID_PITCH_RANGE;
+    if (ui->view_top < rows) ui->view_top = rows < GRID_PITCH_RANGE ? rows : GRID_PITCH_RANGE;
+}
+
+static void invalidate_cell(GridSeqX11UI* ui, int step, int note) {
+    const RollGeometry* geom = &ui->layout.roll;
+    invalidate(ui, geom->left + step * geom->cell_width,
+               geom->top + (ui->view_top - note - 1) * ui->row_height,
+               geom->cell_width, ui->row_height);
+}
+
+// The cell as drawn: the plugin's grid with unconfirmed edits on top
+static bool cell_shown(const GridSeqX11UI* ui, int step, int note) {
+    bool value;
+    if (ui->has_pending && state_edit_get(&ui->pending, (uint8_t)step, (uint8_t)note, &value)) {
+        return value;
+    }
+    return ui->state.grid[step][note];
+}
+
+static bool is_black_key(int note) {
+    int pc = note % 12;
+    return pc == 1 || pc == 3 || pc == 6 || pc == 8 || pc == 10;
+}
+
+// Rows that start an octave of the scale: the key's root, or each C when
+// chromatic in C
+static bool is_root_row(const GridSeqX11UI* ui, int row) {
+    const uint8_t note = state_row_note(&ui->state, (uint8_t)row);
+    return note != SCALE_NO_NOTE && note % 12 == ui->state.key;
+}
+
+// Draw only the rows in view. Cells, grid lines and octave lines are each
+// collected into one path and filled or stroked once, so a dense pattern
+// costs a handful of Cairo operations per frame rather than one per cell.
+static void draw_piano_roll(GridSeqX11UI* ui, cairo_t* cr) {
+    const RollGeometry geom = ui->layout.roll;
+
+    const int length = ui->state.sequence_length;
+    const double rows = roll_visible_rows(ui);
+    int first = (int)floor(ui->view_top - rows);
+    int last = (int)ceil(ui->view_top) - 1;
+    if (first < 0) first = 0;
+    if (last > GRID_PITCH_RANGE - 1) last = GRID_PITCH_RANGE - 1;
+
+    cairo_save(cr);
+    cairo_rectangle(cr, GRID_MARGIN, geom.top, KEY_GUTTER + geom.width, geom.height);
+    cairo_clip(cr);
+
+    // Row backgrounds: alternate octaves, darker rows for black keys, and
+    // the 8 rows the Launchpad shows tinted blue. Rows are scale degrees,
+    // so the keyboard and labels follow the note each row plays.
+    for (int note = first; note <= last; note++) {
+        const uint8_t pitch = state_row_note(&ui->state, (uint8_t)note);
+        double y = geom.top + (ui->view_top - note - 1) * ui->row_height;
+        double shade = pitch == SCALE_NO_NOTE ? 0.05 : ((pitch - ui->state.key) / 12) % 2 ? 0.16 : 0.13;
+        if (pitch != SCALE_NO_NOTE && is_black_key(pitch)) shade -= 0.04;
+
+        bool in_view = note >= ui->state.pitch_offset &&
+                       note < ui->state.pitch_offset + GRID_VISIBLE_ROWS;
+        cairo_set_source_rgb(cr, shade, shade, in_view ? shade + 0.08 : shade);
+        cairo_rectangle(cr, geom.left, y, geom.width, ui->row_height);
+        cairo_fill(cr);
+
+        // Rows with their own loop: the steps they never reach are dimmed
+        const int row_length = state_row_length(&ui->state, (uint8_t)note);
+        if (row_length < length) {
+            double end = geom.left + row_length * geom.cell_width;
+            cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.35);
+            cairo_rectangle(cr, end, y, geom.left + geom.width - end, ui->row_height);
             cairo_fill(cr);
+            cairo_set_source_rgb(cr, 0.9, 0.5, 0.1);
+            cairo_rectangle(cr, end - 1, y, 2, ui->row_height);
+            cairo_fill(cr);
+        }
 
-            // Border
-            cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
-            cairo_set_line_width(cr, 1.0);
-            cairo_rectangle(cr, px, py, ui->cell_size, ui->cell_size);
-            cairo_stroke(cr);
+        // Keyboard gutter
+        if (pitch == SCALE_NO_NOTE) continue;
+        double key = is_black_key(pitch) ? 0.15 : 0.85;
+        cairo_set_source_rgb(cr, key, key, key);
+        cairo_rectangle(cr, GRID_MARGIN, y, KEY_GUTTER - 2, ui->row_height - 1);
+        cairo_fill(cr);
+
+        if (is_root_row(ui, note) && ui->row_height >= 10) {
+            static const char* names[12] = {
+                "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+            };
+            char label[12];
+            snprintf(label, sizeof(label), "%s%d", names[pitch % 12], pitch / 12 - 1);
+            cairo_set_source_rgb(cr, 0.2, 0.2, 0.2);
+            cairo_set_font_size(cr, ui->row_height - 3 < 12 ? ui->row_height - 3 : 12);
+            cairo_move_to(cr, GRID_MARGIN + 3, y + ui->row_height - 3);
+            cairo_show_text(cr, label);
         }
     }
 
+    // Current step
+    if (ui->state.current_step < length) {
+        cairo_set_source_rgba(cr, 0.4, 0.4, 0.7, 0.35);
+        cairo_rectangle(cr, geom.left + ui->state.current_step * geom.cell_width, geom.top,
+                        geom.cell_width, geom.height);
+        cairo_fill(cr);
+    }
+
+    // Step lines
+    cairo_set_line_width(cr, 1.0);
+    cairo_set_source_rgb(cr, 0.25, 0.25, 0.25);
+    for (int x = 1; x < length; x++) {
+        double px = geom.left + x * geom.cell_width + 0.5;
+        cairo_move_to(cr, px, geom.top);
+        cairo_line_to(cr, px, geom.top + geom.height);
+    }
+    cairo_stroke(cr);
+
+    // Octave boundaries below each root
+    cairo_set_source_rgb(cr, 0.35, 0.35, 0.35);
+    for (int note = first; note <= last; note++) {
+        if (!is_root_row(ui, note)) continue;
+        double y = floor(geom.top + (ui->view_top - note) * ui->row_height) + 0.5;
+        cairo_move_to(cr, GRID_MARGIN, y);
+        cairo_line_to(cr, geom.left + geom.width, y);
+    }
+    cairo_stroke(cr);
+
+    // Notes
+    for (int note = first; note <= last; note++) {
+        double y = geom.top + (ui->view_top - note - 1) * ui->row_height;
+        for (int x = 0; x < length; x++) {
+            if (cell_shown(ui, x, note)) {
+                cairo_rectangle(cr, geom.left + x * geom.cell_width + 1, y + 1,
+                                geom.cell_width - 2, ui->row_height - 2);
+            }
+        }
+    }
+    cairo_set_source_rgb(cr, 0.8, 0.8, 0.2);
+    cairo_fill(cr);
+
+    // Ratchets: a cell that retriggers is split into its hits
+    for (int note = first; note <= last; note++) {
+        double y = geom.top + (ui->view_top - note - 1) * ui->row_height;
+        for (int x = 0; x < length; x++) {
+            const int hits = state_ratchet(&ui->state, (uint8_t)x, (uint8_t)note);
+            if (hits < 2 || !cell_shown(ui, x, note)) continue;
+
+            for (int k = 1; k < hits; k++) {
+                cairo_rectangle(cr, geom.left + x * geom.cell_width + k * geom.cell_width / hits - 1,
+                                y + 1, 2, ui->row_height - 2);
+            }
+        }
+    }
+    cairo_set_source_rgb(cr, 0.35, 0.35, 0.1);
+    cairo_fill(cr);
+
+    // Selection
+    const Selection* sel = &ui->selection;
+    if (sel->active) {
+        double x = geom.left + sel->step0 * geom.cell_width;
+        double y = geom.top + (ui->view_top - sel->note1 - 1) * ui->row_height;
+        double w = (sel->step1 - sel->step0 + 1) * geom.cell_width;
+        double h = (sel->note1 - sel->note0 + 1) * ui->row_height;
+
+        cairo_set_source_rgba(cr, 0.5, 0.7, 1.0, 0.2);
+        cairo_rectangle(cr, x, y, w, h);
+        cairo_fill(cr);
+        cairo_set_source_rgb(cr, 0.5, 0.7, 1.0);
+        cairo_set_line_width(cr, 1.0);
+        cairo_rectangle(cr, x + 0.5, y + 0.5, w - 1, h - 1);
+        cairo_stroke(cr);
+    }
+
+    cairo_restore(cr);
+}
+
+static void draw_grid(GridSeqX11UI* ui, cairo_t* cr) {
+    // Clear background
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+    cairo_paint(cr);
+
+    draw_piano_roll(ui, cr);
+
     // Draw buttons in vertical column on the right
-    int button_size = 30;
-    int button_spacing = 5;
-    int buttons_x = WINDOW_WIDTH - button_size - 10;
+    int button_size = BUTTON_SIZE;
+    int button_spacing = BUTTON_SPACING;
+    int buttons_x = ui->layout.buttons_x;
     int buttons_start_y = 10;
 
     cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
@@ -197,19 +470,20 @@ static void draw_grid(GridSeqX11UI* ui) {
     cairo_set_font_size(cr, 22);
     cairo_move_to(cr, buttons_x + 10, current_y + 20);
     cairo_show_text(cr, "-");
-
-    cairo_destroy(cr);
-    ui->needs_redraw = false;
 }
 
-static void draw_settings_dialog(GridSeqX11UI* ui) {
-    if (!ui->settings_surface) return;
+static void draw_settings_dialog(GridSeqX11UI* ui, cairo_t* cr) {
+    cairo_save(cr);
+    cairo_translate(cr, ui->layout.dialog_x, ui->layout.dialog_y);
 
-    cairo_t* cr = cairo_create(ui->settings_surface);
-
-    // Background
+    // Border and background
+    cairo_set_source_rgb(cr, 0.5, 0.5, 0.5);
+    cairo_rectangle(cr, -2, -2, DIALOG_WIDTH + 4, DIALOG_HEIGHT + 4);
+    cairo_fill(cr);
     cairo_set_source_rgb(cr, 0.15, 0.15, 0.15);
-    cairo_paint(cr);
+    cairo_rectangle(cr, 0, 0, DIALOG_WIDTH, DIALOG_HEIGHT);
+    cairo_fill(cr);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
 
     // Title
     cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
@@ -301,7 +575,7 @@ static void draw_settings_dialog(GridSeqX11UI* ui) {
     cairo_move_to(cr, cancel_x + 15, ok_y + 20);
     cairo_show_text(cr, "Cancel");
 
-    cairo_destroy(cr);
+    cairo_restore(cr);
 }
 
 static void open_settings_dialog(GridSeqX11UI* ui) {
@@ -311,30 +585,8 @@ static void open_settings_dialog(GridSeqX11UI* ui) {
     ui->pending_length = ui->state.sequence_length;
     ui->pending_filter = ui->midi_filter_enabled;
 
-    // Create settings window
-    XSetWindowAttributes attrs;
-    attrs.background_pixel = BlackPixel(ui->display, ui->screen);
-    attrs.event_mask = ButtonPressMask | ExposureMask;
-    attrs.override_redirect = True;  // Modal-like behavior
-
-    ui->settings_window = XCreateWindow(
-        ui->display, ui->window,
-        (WINDOW_WIDTH - 360) / 2, (WINDOW_HEIGHT - 220) / 2,
-        360, 220, 2,
-        CopyFromParent, InputOutput, CopyFromParent,
-        CWBackPixel | CWEventMask | CWOverrideRedirect, &attrs
-    );
-
-    ui->settings_surface = cairo_xlib_surface_create(
-        ui->display, ui->settings_window, ui->visual, 360, 220
-    );
-
-    XMapWindow(ui->display, ui->settings_window);
-    XRaiseWindow(ui->display, ui->settings_window);
-
     ui->settings_open = true;
-    draw_settings_dialog(ui);
-    XFlush(ui->display);
+    invalidate_dialog(ui);
 }
 
 static void close_settings_dialog(GridSeqX11UI* ui, bool apply) {
@@ -355,19 +607,12 @@ static void close_settings_dialog(GridSeqX11UI* ui, bool apply) {
         }
     }
 
-    if (ui->settings_surface) {
-        cairo_surface_destroy(ui->settings_surface);
-        ui->settings_surface = NULL;
-    }
-
-    if (ui->settings_window) {
-        XDestroyWindow(ui->display, ui->settings_window);
-        ui->settings_window = 0;
-    }
-
+    // Uncover the roll
     ui->settings_open = false;
+    invalidate_dialog(ui);
 }
 
+// Coordinates are relative to the panel
 static void handle_settings_click(GridSeqX11UI* ui, int mx, int my) {
     // Slider interaction
     int slider_x = 20;
@@ -390,8 +635,7 @@ static void handle_settings_click(GridSeqX11UI* ui, int mx, int my) {
             ui->pending_length = MAX_SEQUENCE_LENGTH;
         }
 
-        draw_settings_dialog(ui);
-        XFlush(ui->display);
+        invalidate_dialog(ui);
         return;
     }
 
@@ -403,8 +647,7 @@ static void handle_settings_click(GridSeqX11UI* ui, int mx, int my) {
     if (mx >= checkbox_x && mx <= checkbox_x + checkbox_size &&
         my >= checkbox_y && my <= checkbox_y + checkbox_size) {
         ui->pending_filter = !ui->pending_filter;
-        draw_settings_dialog(ui);
-        XFlush(ui->display);
+        invalidate_dialog(ui);
         return;
     }
 
@@ -430,13 +673,332 @@ static void handle_settings_click(GridSeqX11UI* ui, int mx, int my) {
     }
 }
 
+// Send one atom to the plugin's MIDI input
+static void send_atom(GridSeqX11UI* ui, const LV2_Atom* atom) {
+    ui->write_function(ui->controller, 0, lv2_atom_total_size(atom),
+                       ui->atom_eventTransfer, atom);
+}
+
+static void send_snapshot_request(GridSeqX11UI* ui) {
+    uint8_t buf[64];
+    lv2_atom_forge_set_buffer(&ui->forge, buf, sizeof(buf));
+
+    LV2_Atom_Forge_Frame frame;
+    lv2_atom_forge_object(&ui->forge, &frame, 0, ui->snapshotRequest);
+    lv2_atom_forge_pop(&ui->forge, &frame);
+
+    send_atom(ui, (const LV2_Atom*)buf);
+}
+
+// Set how many times a cell retriggers within its step
+static void send_ratchet(GridSeqX11UI* ui, int step, int note, int hits) {
+    uint8_t buf[128];
+    lv2_atom_forge_set_buffer(&ui->forge, buf, sizeof(buf));
+
+    LV2_Atom_Forge_Frame frame;
+    lv2_atom_forge_object(&ui->forge, &frame, 0, ui->ratchet);
+    lv2_atom_forge_key(&ui->forge, ui->cellX);
+    lv2_atom_forge_int(&ui->forge, step);
+    lv2_atom_forge_key(&ui->forge, ui->cellY);
+    lv2_atom_forge_int(&ui->forge, note);
+    lv2_atom_forge_key(&ui->forge, ui->cellValue);
+    lv2_atom_forge_int(&ui->forge, hits);
+    lv2_atom_forge_pop(&ui->forge, &frame);
+
+    send_atom(ui, (const LV2_Atom*)buf);
+}
+
+// Give a row its own loop length; 0 makes it follow the sequence again
+static void send_row_length(GridSeqX11UI* ui, int note, int length) {
+    uint8_t buf[128];
+    lv2_atom_forge_set_buffer(&ui->forge, buf, sizeof(buf));
+
+    LV2_Atom_Forge_Frame frame;
+    lv2_atom_forge_object(&ui->forge, &frame, 0, ui->rowLength);
+    lv2_atom_forge_key(&ui->forge, ui->cellY);
+    lv2_atom_forge_int(&ui->forge, note);
+    lv2_atom_forge_key(&ui->forge, ui->cellValue);
+    lv2_atom_forge_int(&ui->forge, length);
+    lv2_atom_forge_pop(&ui->forge, &frame);
+
+    send_atom(ui, (const LV2_Atom*)buf);
+}
+
+// Send one edit transaction and show it until the plugin confirms it
+static void send_edit(GridSeqX11UI* ui, const GridEdit* edit) {
+    uint8_t buf[sizeof(LV2_Atom) + sizeof(GridEdit)];
+    lv2_atom_forge_set_buffer(&ui->forge, buf, sizeof(buf));
+    lv2_atom_forge_atom(&ui->forge, sizeof(GridEdit), ui->gridEdit);
+    lv2_atom_forge_write(&ui->forge, edit, sizeof(GridEdit));
+    send_atom(ui, (const LV2_Atom*)buf);
+
+    if (!ui->has_pending) state_edit_clear(&ui->pending);
+    for (int x = 0; x < MAX_GRID_SIZE; x++) {
+        for (int byte = 0; byte < GRID_SNAPSHOT_COLUMN_BYTES; byte++) {
+            const uint8_t mask = edit->mask[x][byte];
+            ui->pending.cells[x][byte] = (uint8_t)((ui->pending.cells[x][byte] & ~mask) |
+                                                   (edit->cells[x][byte] & mask));
+            ui->pending.mask[x][byte] |= mask;
+        }
+    }
+    ui->has_pending = true;
+    invalidate_roll(ui);
+}
+
+// Roll cell under a point, false outside the roll or the sequence
+static bool cell_at(const GridSeqX11UI* ui, int mx, int my, int* step, int* note) {
+    const RollGeometry* geom = &ui->layout.roll;
+    if (mx < geom->left || my < geom->top || my >= geom->top + geom->height) return false;
+
+    int x = (mx - geom->left) / geom->cell_width;
+    int n = (int)floor(ui->view_top - (double)(my - geom->top) / ui->row_height);
+    if (x < 0 || x >= ui->state.sequence_length || n < 0 || n >= GRID_PITCH_RANGE) return false;
+
+    *step = x;
+    *note = n;
+    return true;
+}
+
+static void select_cells(GridSeqX11UI* ui, int step0, int note0, int step1, int note1) {
+    Selection* sel = &ui->selection;
+    sel->active = true;
+    sel->step0 = step0 < step1 ? step0 : step1;
+    sel->step1 = step0 < step1 ? step1 : step0;
+    sel->note0 = note0 < note1 ? note0 : note1;
+    sel->note1 = note0 < note1 ? note1 : note0;
+    invalidate_roll(ui);
+}
+
+static void clear_selection(GridSeqX11UI* ui) {
+    if (!ui->selection.active) return;
+    ui->selection.active = false;
+    invalidate_roll(ui);
+}
+
+// Area the keyboard commands act on: the selection, or else every step
+// across the notes in use. False when that is empty.
+static bool edit_region(const GridSeqX11UI* ui, Selection* region) {
+    if (ui->selection.active) {
+        *region = ui->selection;
+        if (region->step1 >= ui->state.sequence_length) region->step1 = ui->state.sequence_length - 1;
+        return region->step0 <= region->step1;
+    }
+
+    region->active = false;
+    region->step0 = 0;
+    region->step1 = ui->state.sequence_length - 1;
+    region->note0 = GRID_PITCH_RANGE;
+    region->note1 = -1;
+    for (int x = 0; x <= region->step1; x++) {
+        for (int note = 0; note < GRID_PITCH_RANGE; note++) {
+            if (!cell_shown(ui, x, note)) continue;
+            if (note < region->note0) region->note0 = note;
+            if (note > region->note1) region->note1 = note;
+        }
+    }
+    return region->note0 <= region->note1;
+}
+
+static void begin_paint(GridSeqX11UI* ui, int step, int note) {
+    ui->drag = DRAG_PAINT;
+    ui->paint_value = !cell_shown(ui, step, note);
+    state_edit_clear(&ui->stroke);
+}
+
+// Add the cell under the pointer to the stroke, drawn at once
+static void paint_cell(GridSeqX11UI* ui, int step, int note) {
+    bool value;
+    if (state_edit_get(&ui->stroke, (uint8_t)step, (uint8_t)note, &value)) return;
+
+    state_edit_set(&ui->stroke, (uint8_t)step, (uint8_t)note, ui->paint_value);
+    if (!ui->has_pending) {
+        state_edit_clear(&ui->pending);
+        ui->has_pending = true;
+    }
+    state_edit_set(&ui->pending, (uint8_t)step, (uint8_t)note, ui->paint_value);
+    invalidate_cell(ui, step, note);
+}
+
+static void end_drag(GridSeqX11UI* ui) {
+    if (ui->drag == DRAG_PAINT) {
+        send_edit(ui, &ui->stroke);
+    }
+    ui->drag = DRAG_NONE;
+}
+
+// Rotate the region one step left or right, wrapping inside it
+static void shift_steps(GridSeqX11UI* ui, int delta) {
+    Selection r;
+    if (!edit_region(ui, &r)) return;
+
+    const int width = r.step1 - r.step0 + 1;
+    GridEdit edit;
+    state_edit_clear(&edit);
+    for (int x = r.step0; x <= r.step1; x++) {
+        int to = r.step0 + ((x - r.step0 + delta) % width + width) % width;
+        for (int note = r.note0; note <= r.note1; note++) {
+            state_edit_set(&edit, (uint8_t)to, (uint8_t)note, cell_shown(ui, x, note));
+        }
+    }
+    send_edit(ui, &edit);
+}
+
+// Move the region's notes up or down; refused if any would leave 0-127
+static void transpose(GridSeqX11UI* ui, int semitones) {
+    Selection r;
+    if (!edit_region(ui, &r)) return;
+    if (r.note0 + semitones < 0 || r.note1 + semitones >= GRID_PITCH_RANGE) return;
+
+    GridEdit edit;
+    state_edit_clear(&edit);
+    for (int x = r.step0; x <= r.step1; x++) {
+        for (int note = r.note0; note <= r.note1; note++) {
+            state_edit_set(&edit, (uint8_t)x, (uint8_t)note, false);
+        }
+    }
+    for (int x = r.step0; x <= r.step1; x++) {
+        for (int note = r.note0; note <= r.note1; note++) {
+            if (cell_shown(ui, x, note)) {
+                state_edit_set(&edit, (uint8_t)x, (uint8_t)(note + semitones), true);
+            }
+        }
+    }
+    send_edit(ui, &edit);
+
+    if (ui->selection.active) {
+        ui->selection.note0 += semitones;
+        ui->selection.note1 += semitones;
+    }
+}
+
+static void delete_cells(GridSeqX11UI* ui) {
+    Selection r;
+    if (!edit_region(ui, &r)) return;
+
+    GridEdit edit;
+    state_edit_clear(&edit);
+    for (int x = r.step0; x <= r.step1; x++) {
+        for (int note = r.note0; note <= r.note1; note++) {
+            state_edit_set(&edit, (uint8_t)x, (uint8_t)note, false);
+        }
+    }
+    send_edit(ui, &edit);
+}
+
+// Every nth step of each selected note on, the others off
+static void fill_every(GridSeqX11UI* ui, int n) {
+    Selection r;
+    if (!ui->selection.active || !edit_region(ui, &r)) return;
+
+    GridEdit edit;
+    state_edit_clear(&edit);
+    for (int x = r.step0; x <= r.step1; x++) {
+        for (int note = r.note0; note <= r.note1; note++) {
+            state_edit_set(&edit, (uint8_t)x, (uint8_t)note, (x - r.step0) % n == 0);
+        }
+    }
+    send_edit(ui, &edit);
+}
+
+// Ask the plugin to run a generator; the result arrives with the
+// snapshot after the next bar starts
+static void send_generate(GridSeqX11UI* ui, const GenRequest* request) {
+    uint8_t buf[sizeof(LV2_Atom) + sizeof(GenRequest)];
+    lv2_atom_forge_set_buffer(&ui->forge, buf, sizeof(buf));
+    lv2_atom_forge_atom(&ui->forge, sizeof(GenRequest), ui->generate);
+    lv2_atom_forge_write(&ui->forge, request, sizeof(GenRequest));
+    send_atom(ui, (const LV2_Atom*)buf);
+}
+
+// One more Euclidean hit on the row under the pointer, over the row's loop
+static void generate_euclid(GridSeqX11UI* ui) {
+    if (ui->hover_step < 0) return;
+
+    const uint8_t note = (uint8_t)ui->hover_note;
+    const uint8_t length = state_row_length(&ui->state, note);
+    uint8_t hits = 0;
+    for (uint8_t x = 0; x < length; x++) {
+        if (cell_shown(ui, x, note)) hits++;
+    }
+
+    GenRequest request;
+    memset(&request, 0, sizeof(request));
+    request.algorithm = GEN_EUCLID;
+    request.note = note;
+    request.rows = 1;
+    request.steps = length;
+    request.hits = (uint8_t)((hits + 1) % (length + 1));
+    send_generate(ui, &request);
+}
+
+// Random fill or mutation of the edit region
+static void generate_region(GridSeqX11UI* ui, GenAlgorithm algorithm, uint8_t amount) {
+    Selection r;
+    if (!edit_region(ui, &r)) return;
+
+    ui->gen_seed = ui->gen_seed * 1664525u + 1013904223u;
+
+    GenRequest request;
+    memset(&request, 0, sizeof(request));
+    request.algorithm = (uint8_t)algorithm;
+    request.note = (uint8_t)r.note0;
+    request.rows = (uint8_t)(r.note1 - r.note0 + 1);
+    request.step = (uint8_t)r.step0;
+    request.steps = (uint8_t)(r.step1 - r.step0 + 1);
+    request.amount = amount;
+    request.seed = ui->gen_seed;
+    send_generate(ui, &request);
+}
+
+static void copy_cells(GridSeqX11UI* ui) {
+    Selection r;
+    if (!edit_region(ui, &r)) return;
+
+    ui->clip_steps = r.step1 - r.step0 + 1;
+    ui->clip_notes = r.note1 - r.note0 + 1;
+    for (int i = 0; i < ui->clip_steps; i++) {
+        for (int j = 0; j < ui->clip_notes; j++) {
+            ui->clipboard[i][j] = cell_shown(ui, r.step0 + i, r.note0 + j);
+        }
+    }
+}
+
+// Paste with the copied area's first step and lowest note at the pointer,
+// or at the selection without one; the pasted area becomes the selection
+static void paste_cells(GridSeqX11UI* ui) {
+    if (!ui->clip_steps) return;
+
+    int step = ui->hover_step;
+    int note = ui->hover_note;
+    if (step < 0) {
+        if (!ui->selection.active) return;
+        step = ui->selection.step0;
+        note = ui->selection.note0;
+    }
+
+    int steps = ui->clip_steps;
+    int notes = ui->clip_notes;
+    if (step + steps > ui->state.sequence_length) steps = ui->state.sequence_length - step;
+    if (note + notes > GRID_PITCH_RANGE) notes = GRID_PITCH_RANGE - note;
+
+    GridEdit edit;
+    state_edit_clear(&edit);
+    for (int i = 0; i < steps; i++) {
+        for (int j = 0; j < notes; j++) {
+            state_edit_set(&edit, (uint8_t)(step + i), (uint8_t)(note + j), ui->clipboard[i][j]);
+        }
+    }
+    send_edit(ui, &edit);
+    select_cells(ui, step, note, step + steps - 1, note + notes - 1);
+}
+
 static void handle_button_press(GridSeqX11UI* ui, int mx, int my) {
     fprintf(stderr, "grid-seq: X11 button press at (%d, %d)\n", mx, my);
 
     // Buttons are in vertical column on the right
-    int button_size = 30;
-    int button_spacing = 5;
-    int buttons_x = WINDOW_WIDTH - button_size - 10;
+    int button_size = BUTTON_SIZE;
+    int button_spacing = BUTTON_SPACING;
+    int buttons_x = ui->layout.buttons_x;
     int buttons_start_y = 10;
 
     // Check if click is in button column
@@ -479,7 +1041,8 @@ static void handle_button_press(GridSeqX11UI* ui, int mx, int my) {
                     ui->state.grid[i][j] = false;
                 }
             }
-            ui->needs_redraw = true;
+            ui->has_pending = false;
+            invalidate_all(ui);
 
             float clear_signal = -300.0f;
             ui->write_function(ui->controller, 3, sizeof(float), 0, &clear_signal);
@@ -551,24 +1114,199 @@ static void handle_button_press(GridSeqX11UI* ui, int mx, int my) {
             return;
         }
     }
+}
+
+// Wheel scrolls the piano roll; with Ctrl it zooms around the pointer
+static void handle_wheel(GridSeqX11UI* ui, int my, bool up, bool zoom) {
+    if (zoom) {
+        const RollGeometry geom = ui->layout.roll;
+
+        double anchor = ui->view_top - (double)(my - geom.top) / ui->row_height;
+        int height = ui->row_height + (up ? 2 : -2);
+        if (height < ROW_HEIGHT_MIN) height = ROW_HEIGHT_MIN;
+        if (height > ROW_HEIGHT_MAX) height = ROW_HEIGHT_MAX;
+
+        ui->row_height = height;
+        ui->view_top = anchor + (double)(my - geom.top) / ui->row_height;
+    } else {
+        ui->view_top += up ? SCROLL_ROWS : -SCROLL_ROWS;
+    }
+
+    clamp_view(ui);
+    invalidate_all(ui);
+}
 
-    // Calculate grid cell click
-    int x = (mx - GRID_MARGIN) / (ui->cell_size + GRID_SPACING);
-    int y = (my - GRID_MARGIN) / (ui->cell_size + GRID_SPACING);
+// Apply a new window size in pixels
+static void set_size(GridSeqX11UI* ui, int width, int height) {
+    if (!canvas_resize(ui->canvas, width, height, ui->scale)) return;
 
-    if (x >= 0 && x < ui->state.sequence_length && y >= 0 && y < GRID_VISIBLE_ROWS) {
-        // Flip Y coordinate - send window-relative row (0-7)
-        // Plugin will add pitch_offset to get absolute MIDI note
-        int grid_y = GRID_VISIBLE_ROWS - 1 - y;
+    ui->layout.width = (int)(width / ui->scale);
+    ui->layout.height = (int)(height / ui->scale);
+    update_layout(ui);
+    clamp_view(ui);
+}
 
-        // Send to plugin - DON'T toggle locally, wait for port update from plugin
-        float fx = (float)x;
-        float fy = (float)grid_y;
-        ui->write_function(ui->controller, 3, sizeof(float), 0, &fx);  // PORT_GRID_X
-        ui->write_function(ui->controller, 4, sizeof(float), 0, &fy);  // PORT_GRID_Y
+// pugl callbacks. pugl reports pixels; the UI works in logical units.
 
-        fprintf(stderr, "grid-seq: Sent toggle request for cell [%d,%d] (window-relative row)\n", x, grid_y);
+// An indirect context sends every texture upload as GLX protocol: present
+// through an MIT-SHM back buffer instead, and stop pugl swapping over it
+static void choose_presenter(GridSeqX11UI* ui) {
+    ui->presenter_chosen = true;
+
+    Display* display = glXGetCurrentDisplay();
+    if (glXIsDirect(display, glXGetCurrentContext())) return;
+
+    const Window window = (Window)puglGetNativeWindow(ui->view);
+    XWindowAttributes attributes;
+    if (XGetWindowAttributes(display, window, &attributes) &&
+        canvas_use_backbuffer(ui->canvas, display, window, attributes.visual, attributes.depth)) {
+        puglSetSwapBuffers(ui->view, false);
+    }
+}
+
+static void on_display(PuglView* view) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    if (!ui->presenter_chosen) choose_presenter(ui);
+
+    // An Expose without damage only redraws the texture
+    cairo_t* cr = canvas_begin(ui->canvas);
+    if (cr) {
+        draw_grid(ui, cr);
+        if (ui->settings_open) draw_settings_dialog(ui, cr);
+        canvas_end(ui->canvas, cr);
     }
+    canvas_present(ui->canvas);
+}
+
+static bool on_native_event(PuglView* view, const void* event) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+
+    bool redraw = false;
+    if (!canvas_handle_event(ui->canvas, (const XEvent*)event, &redraw)) return false;
+    if (redraw) puglPostRedisplay(view);
+    return true;
+}
+
+static void on_reshape(PuglView* view, int width, int height) {
+    set_size((GridSeqX11UI*)puglGetHandle(view), width, height);
+}
+
+static void on_resize(PuglView* view, int* width, int* height, int* set_hints) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+
+    *width = ui->requested_width;
+    *height = ui->requested_height;
+    *set_hints = 0;  // Constraints are set once, at instantiate
+}
+
+static void on_mouse(PuglView* view, int button, bool press, int x, int y) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    (void)button;
+
+    if (!press) {
+        end_drag(ui);
+        return;
+    }
+
+    int mx = (int)(x / ui->scale);
+    int my = (int)(y / ui->scale);
+    int step, note;
+
+    // The settings panel is modal
+    if (ui->settings_open) {
+        handle_settings_click(ui, mx - ui->layout.dialog_x, my - ui->layout.dialog_y);
+    } else if (cell_at(ui, mx, my, &step, &note)) {
+        // Ctrl-click ends the row's loop after the cell (again to undo),
+        // Shift-drag selects, a plain drag paints
+        const int mods = puglGetModifiers(view);
+        if (mods & PUGL_MOD_CTRL) {
+            const bool own = ui->state.row_length[note] == step + 1;
+            send_row_length(ui, note, own ? 0 : step + 1);
+        } else if (mods & PUGL_MOD_SHIFT) {
+            ui->drag = DRAG_SELECT;
+            ui->anchor_step = step;
+            ui->anchor_note = note;
+            select_cells(ui, step, note, step, note);
+        } else {
+            clear_selection(ui);
+            begin_paint(ui, step, note);
+            paint_cell(ui, step, note);
+        }
+    } else {
+        handle_button_press(ui, mx, my);
+    }
+}
+
+static void on_motion(PuglView* view, int x, int y) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    int step, note;
+
+    if (!cell_at(ui, (int)(x / ui->scale), (int)(y / ui->scale), &step, &note)) {
+        ui->hover_step = ui->hover_note = -1;
+        return;
+    }
+    ui->hover_step = step;
+    ui->hover_note = note;
+
+    if (ui->drag == DRAG_PAINT) {
+        paint_cell(ui, step, note);
+    } else if (ui->drag == DRAG_SELECT) {
+        select_cells(ui, ui->anchor_step, ui->anchor_note, step, note);
+    }
+}
+
+static void on_keyboard(PuglView* view, bool press, uint32_t key) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    if (!press || ui->settings_open) return;
+
+    const bool ctrl = (puglGetModifiers(view) & PUGL_MOD_CTRL) != 0;
+
+    // With Ctrl, X11 reports C and V as control characters
+    if (key == 0x03 || (ctrl && (key == 'c' || key == 'C'))) {
+        copy_cells(ui);
+    } else if (key == 0x16 || (ctrl && (key == 'v' || key == 'V'))) {
+        paste_cells(ui);
+    } else if (key == PUGL_CHAR_DELETE || key == PUGL_CHAR_BACKSPACE) {
+        delete_cells(ui);
+    } else if (key == PUGL_CHAR_ESCAPE) {
+        clear_selection(ui);
+    } else if (key >= '1' && key <= '8') {
+        fill_every(ui, (int)(key - '0'));
+    } else if (key == 'e' || key == 'E') {
+        generate_euclid(ui);
+    } else if (key == 'g' || key == 'G') {
+        generate_region(ui, GEN_RANDOM, 25);
+    } else if (key == 'm' || key == 'M') {
+        generate_region(ui, GEN_MUTATE, 10);
+    } else if ((key == 'r' || key == 'R') && ui->hover_step >= 0) {
+        // Cycle the cell under the pointer through 1 to MAX_RATCHET hits
+        const int hits = state_ratchet(&ui->state, (uint8_t)ui->hover_step, (uint8_t)ui->hover_note);
+        send_ratchet(ui, ui->hover_step, ui->hover_note, hits % MAX_RATCHET + 1);
+    }
+}
+
+static void on_special(PuglView* view, bool press, PuglKey key) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    if (!press || ui->settings_open) return;
+
+    const int octave = (puglGetModifiers(view) & PUGL_MOD_SHIFT) ? 12 : 1;
+    switch (key) {
+        case PUGL_KEY_LEFT:  shift_steps(ui, -1); break;
+        case PUGL_KEY_RIGHT: shift_steps(ui, 1); break;
+        case PUGL_KEY_UP:    transpose(ui, octave); break;
+        case PUGL_KEY_DOWN:  transpose(ui, -octave); break;
+        default: break;
+    }
+}
+
+static void on_scroll(PuglView* view, int x, int y, float dx, float dy) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)puglGetHandle(view);
+    (void)x;
+    (void)dx;
+    if (dy == 0.0f || ui->settings_open) return;
+
+    handle_wheel(ui, (int)(y / ui->scale), dy > 0.0f,
+                 (puglGetModifiers(view) & PUGL_MOD_CTRL) != 0);
 }
 
 static LV2UI_Handle instantiate(
@@ -592,6 +1330,7 @@ static LV2UI_Handle instantiate(
 
     // Get features
     void* parent = NULL;
+    const LV2_Options_Option* options = NULL;
     for (int i = 0; features[i]; i++) {
         if (strcmp(features[i]->URI, LV2_URID__map) == 0) {
             ui->map = (LV2_URID_Map*)features[i]->data;
@@ -599,6 +1338,10 @@ static LV2UI_Handle instantiate(
             ui->port_subscribe = (const LV2UI_Port_Subscribe*)features[i]->data;
         } else if (strcmp(features[i]->URI, LV2_UI__parent) == 0) {
             parent = features[i]->data;
+        } else if (strcmp(features[i]->URI, LV2_UI__resize) == 0) {
+            ui->host_resize = (const LV2UI_Resize*)features[i]->data;
+        } else if (strcmp(features[i]->URI, LV2_OPTIONS__options) == 0) {
+            options = (const LV2_Options_Option*)features[i]->data;
         }
     }
 
@@ -609,67 +1352,92 @@ static LV2UI_Handle instantiate(
 
     // Map URIDs for MIDI messages
     ui->midi_MidiEvent = ui->map->map(ui->map->handle, LV2_MIDI__MidiEvent);
+    ui->atom_eventTransfer = ui->map->map(ui->map->handle, LV2_ATOM__eventTransfer);
+    ui->gridState = ui->map->map(ui->map->handle, GRID_SEQ__gridState);
+    ui->snapshotRequest = ui->map->map(ui->map->handle, GRID_SEQ__snapshotRequest);
+    ui->gridEdit = ui->map->map(ui->map->handle, GRID_SEQ__gridEdit);
+    ui->rowLength = ui->map->map(ui->map->handle, GRID_SEQ__rowLength);
+    ui->ratchet = ui->map->map(ui->map->handle, GRID_SEQ__ratchet);
+    ui->generate = ui->map->map(ui->map->handle, GRID_SEQ__generate);
+    ui->cellX = ui->map->map(ui->map->handle, GRID_SEQ__cellX);
+    ui->cellY = ui->map->map(ui->map->handle, GRID_SEQ__cellY);
+    ui->cellValue = ui->map->map(ui->map->handle, GRID_SEQ__cellValue);
+
+    // A scale factor from the host wins over the display's
+    const LV2_URID ui_scaleFactor = ui->map->map(ui->map->handle, LV2_UI__scaleFactor);
+    const LV2_URID atom_Float = ui->map->map(ui->map->handle, LV2_ATOM__Float);
+    for (const LV2_Options_Option* o = options; o && o->key; o++) {
+        if (o->key == ui_scaleFactor && o->type == atom_Float && o->value) {
+            ui->scale = *(const float*)o->value;
+        }
+    }
 
     // Initialize atom forge
     lv2_atom_forge_init(&ui->forge, ui->map);
 
     // Initialize state
     state_init(&ui->state, 48000.0);
-    ui->needs_redraw = true;
     ui->settings_open = false;
-    ui->settings_window = 0;
-    ui->settings_surface = NULL;
     ui->midi_filter_enabled = false;
-
-    // Open X11 display
-    ui->display = XOpenDisplay(NULL);
-    if (!ui->display) {
-        fprintf(stderr, "grid-seq: Failed to open X11 display\n");
+    ui->row_height = ROW_HEIGHT_DEFAULT;
+    ui->view_top = GRID_PITCH_RANGE;
+    ui->view_placed = false;
+    ui->hover_step = ui->hover_note = -1;
+    ui->gen_seed = (uint32_t)time(NULL);
+
+    ui->canvas = canvas_create();
+    ui->view = puglCreate((PuglNativeWindow)(uintptr_t)parent, "grid-seq",
+                          WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_WIDTH, WINDOW_HEIGHT,
+                          true, false, 0);
+    if (!ui->canvas || !ui->view) {
+        fprintf(stderr, "grid-seq: Failed to create the UI window\n");
+        puglDestroy(ui->view);
+        canvas_destroy(ui->canvas);
         free(ui);
         return NULL;
     }
 
-    ui->screen = DefaultScreen(ui->display);
-    ui->visual = DefaultVisual(ui->display, ui->screen);
-    Window root = DefaultRootWindow(ui->display);
-
-    // Create window
-    XSetWindowAttributes attrs;
-    attrs.background_pixel = BlackPixel(ui->display, ui->screen);
-    attrs.event_mask = ButtonPressMask | ButtonReleaseMask | ExposureMask | StructureNotifyMask;
-
-    ui->window = XCreateWindow(
-        ui->display, parent ? (Window)(uintptr_t)parent : root,
-        0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0,
-        CopyFromParent, InputOutput, CopyFromParent,
-        CWBackPixel | CWEventMask, &attrs
-    );
-
-    if (!ui->window) {
-        fprintf(stderr, "grid-seq: Failed to create X11 window\n");
-        XCloseDisplay(ui->display);
-        free(ui);
-        return NULL;
+    if (ui->scale <= 0.0) ui->scale = puglGetHWSurfaceScale(ui->view);
+    if (ui->scale < 1.0) ui->scale = 1.0;
+
+    puglSetHandle(ui->view, ui);
+    puglSetDisplayFunc(ui->view, on_display);
+    puglSetReshapeFunc(ui->view, on_reshape);
+    puglSetResizeFunc(ui->view, on_resize);
+    puglSetMouseFunc(ui->view, on_mouse);
+    puglSetMotionFunc(ui->view, on_motion);
+    puglSetKeyboardFunc(ui->view, on_keyboard);
+    puglSetSpecialFunc(ui->view, on_special);
+    puglIgnoreKeyRepeat(ui->view, false);
+    puglSetScrollFunc(ui->view, on_scroll);
+    puglSetNativeEventFunc(ui->view, on_native_event);
+
+    const int width = (int)(WINDOW_WIDTH * ui->scale);
+    const int height = (int)(WINDOW_HEIGHT * ui->scale);
+    puglUpdateGeometryConstraints(ui->view, (int)(WINDOW_MIN_WIDTH * ui->scale),
+                                  (int)(WINDOW_MIN_HEIGHT * ui->scale), false);
+
+    // The window was created unscaled; grow it on the first idle
+    set_size(ui, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (width != WINDOW_WIDTH || height != WINDOW_HEIGHT) {
+        ui->requested_width = width;
+        ui->requested_height = height;
+        puglPostResize(ui->view);
+    }
+    if (ui->host_resize) {
+        ui->host_resize->ui_resize(ui->host_resize->handle, width, height);
+    }
+    if (!parent) {
+        puglShowWindow(ui->view);
     }
-
-    // Create Cairo surface
-    ui->surface = cairo_xlib_surface_create(
-        ui->display, ui->window, ui->visual,
-        WINDOW_WIDTH, WINDOW_HEIGHT
-    );
-
-    XMapWindow(ui->display, ui->window);
-    XFlush(ui->display);
 
     // Subscribe to ports
     if (ui->port_subscribe) {
         // Subscribe to current_step (port 5)
         ui->port_subscribe->subscribe(ui->port_subscribe->handle, 5, 0, NULL);
 
-        // Subscribe to grid row ports (8-23)
-        for (uint32_t i = 8; i <= 23; i++) {
-            ui->port_subscribe->subscribe(ui->port_subscribe->handle, i, 0, NULL);
-        }
+        // Subscribe to notify (port 7) for grid snapshots
+        ui->port_subscribe->subscribe(ui->port_subscribe->handle, 7, ui->atom_eventTransfer, NULL);
 
         // Subscribe to sequence_length (port 24)
         ui->port_subscribe->subscribe(ui->port_subscribe->handle, 24, 0, NULL);
@@ -678,9 +1446,10 @@ static LV2UI_Handle instantiate(
         ui->port_subscribe->subscribe(ui->port_subscribe->handle, 25, 0, NULL);
     }
 
-    *widget = (LV2UI_Widget)(uintptr_t)ui->window;
+    *widget = (LV2UI_Widget)puglGetNativeWindow(ui->view);
 
-    fprintf(stderr, "grid-seq: X11 UI created, window=0x%lx parent=%p\n", ui->window, parent);
+    // The grid comes from the plugin as a snapshot
+    send_snapshot_request(ui);
 
     return (LV2UI_Handle)ui;
 }
@@ -692,10 +1461,8 @@ static void cleanup(LV2UI_Handle handle) {
         // Unsubscribe from current_step
         ui->port_subscribe->unsubscribe(ui->port_subscribe->handle, 5, 0, NULL);
 
-        // Unsubscribe from grid rows
-        for (uint32_t i = 8; i <= 23; i++) {
-            ui->port_subscribe->unsubscribe(ui->port_subscribe->handle, i, 0, NULL);
-        }
+        // Unsubscribe from notify
+        ui->port_subscribe->unsubscribe(ui->port_subscribe->handle, 7, ui->atom_eventTransfer, NULL);
 
         // Unsubscribe from sequence_length
         ui->port_subscribe->unsubscribe(ui->port_subscribe->handle, 24, 0, NULL);
@@ -704,22 +1471,11 @@ static void cleanup(LV2UI_Handle handle) {
         ui->port_subscribe->unsubscribe(ui->port_subscribe->handle, 25, 0, NULL);
     }
 
-    // Close settings dialog if open
-    if (ui->settings_open) {
-        close_settings_dialog(ui, false);
-    }
-
-    if (ui->surface) {
-        cairo_surface_destroy(ui->surface);
-    }
-
-    if (ui->window) {
-        XDestroyWindow(ui->display, ui->window);
-    }
-
-    if (ui->display) {
-        XCloseDisplay(ui->display);
-    }
+    // The canvas texture and back buffer go before the context and display
+    puglEnterContext(ui->view);
+    canvas_destroy(ui->canvas);
+    puglLeaveContext(ui->view);
+    puglDestroy(ui->view);
 
     free(ui);
 }
@@ -732,24 +1488,26 @@ static void port_event(
     const void* buffer
 ) {
     GridSeqX11UI* ui = (GridSeqX11UI*)handle;
-    (void)buffer_size;
-    (void)format;
 
     // Current step (port 5)
     if (port_index == 5 && buffer) {
         uint8_t new_step = (uint8_t)(*(const float*)buffer);
-        if (new_step < MAX_GRID_SIZE) {
+        if (new_step < MAX_GRID_SIZE && new_step != ui->state.current_step) {
+            // Only the two step columns change on screen
+            invalidate_step(ui, ui->state.current_step);
+            invalidate_step(ui, new_step);
             ui->state.current_step = new_step;
-            ui->needs_redraw = true;
         }
     }
 
     // Sequence length (port 24)
     if (port_index == 24 && buffer) {
         uint8_t new_length = (uint8_t)(*(const float*)buffer);
-        if (new_length >= MIN_SEQUENCE_LENGTH && new_length <= MAX_SEQUENCE_LENGTH) {
+        if (new_length >= MIN_SEQUENCE_LENGTH && new_length <= MAX_SEQUENCE_LENGTH &&
+            new_length != ui->state.sequence_length) {
             ui->state.sequence_length = new_length;
-            ui->needs_redraw = true;
+            update_layout(ui);
+            invalidate_all(ui);
         }
     }
 
@@ -759,56 +1517,49 @@ static void port_event(
         ui->midi_filter_enabled = (filter_value > 0.5f);
     }
 
-    // Grid rows (ports 8-23)
-    if (port_index >= 8 && port_index <= 23 && buffer) {
-        int x = port_index - 8;
-        uint8_t row_value = (uint8_t)(*(const float*)buffer);
-
-        for (int y = 0; y < GRID_VISIBLE_ROWS; y++) {
-            ui->state.grid[x][y] = (row_value & (1 << y)) != 0;
+    // Grid snapshots on notify (port 7); the grid_row ports only carry the
+    // Launchpad's 8-row window and are not used by the piano roll
+    if (port_index == 7 && buffer && format == ui->atom_eventTransfer &&
+        buffer_size >= sizeof(LV2_Atom)) {
+        const LV2_Atom* atom = (const LV2_Atom*)buffer;
+        if (atom->type == ui->gridState && atom->size >= sizeof(GridSnapshot)) {
+            state_unpack_snapshot(&ui->state, (const GridSnapshot*)(atom + 1));
+            update_layout(ui);
+
+            // The snapshot includes every edit sent so far, except a
+            // paint stroke still in progress
+            ui->has_pending = ui->drag == DRAG_PAINT;
+            if (ui->has_pending) ui->pending = ui->stroke;
+
+            // Start with the Launchpad's rows in the middle of the view
+            if (!ui->view_placed) {
+                ui->view_top = ui->state.pitch_offset + GRID_VISIBLE_ROWS / 2 +
+                               roll_visible_rows(ui) / 2;
+                clamp_view(ui);
+                ui->view_placed = true;
+            }
+            invalidate_all(ui);
         }
-
-        ui->needs_redraw = true;
     }
 }
 
 static int idle(LV2UI_Handle handle) {
     GridSeqX11UI* ui = (GridSeqX11UI*)handle;
 
-    // Process X11 events
-    while (XPending(ui->display) > 0) {
-        XEvent event;
-        XNextEvent(ui->display, &event);
-
-        switch (event.type) {
-            case ButtonPress:
-                fprintf(stderr, "grid-seq: ButtonPress event received!\n");
-                // Check if click is on settings window
-                if (ui->settings_open && event.xbutton.window == ui->settings_window) {
-                    handle_settings_click(ui, event.xbutton.x, event.xbutton.y);
-                } else {
-                    handle_button_press(ui, event.xbutton.x, event.xbutton.y);
-                }
-                break;
-
-            case Expose:
-                // Redraw appropriate window
-                if (ui->settings_open && event.xexpose.window == ui->settings_window) {
-                    draw_settings_dialog(ui);
-                    XFlush(ui->display);
-                } else {
-                    ui->needs_redraw = true;
-                }
-                break;
-        }
-    }
+    // Dispatches input and draws only after an Expose or new damage
+    puglProcessEvents(ui->view);
+    return 0;
+}
 
-    // Redraw if needed
-    if (ui->needs_redraw) {
-        draw_grid(ui);
-        XFlush(ui->display);
-    }
+// Host-driven resize (ui:resize as extension data), in pixels
+static int resize(LV2UI_Feature_Handle handle, int width, int height) {
+    GridSeqX11UI* ui = (GridSeqX11UI*)handle;
 
+    const int min_width = (int)(WINDOW_MIN_WIDTH * ui->scale);
+    const int min_height = (int)(WINDOW_MIN_HEIGHT * ui->scale);
+    ui->requested_width = width > min_width ? width : min_width;
+    ui->requested_height = height > min_height ? height : min_height;
+    puglPostResize(ui->view);
     return 0;
 }
 
@@ -816,10 +1567,18 @@ static const LV2UI_Idle_Interface idle_iface = {
     idle
 };
 
+static const LV2UI_Resize resize_iface = {
+    NULL,
+    resize
+};
+
 static const void* extension_data(const char* uri) {
     if (!strcmp(uri, LV2_UI__idleInterface)) {
         return &idle_iface;
     }
+    if (!strcmp(uri, LV2_UI__resize)) {
+        return &resize_iface;
+    }
     return NULL;
 }
 
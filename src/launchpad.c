@@ -24,12 +24,31 @@ struct LaunchpadController {
     char device_path[256];
 };
 
-LaunchpadController* launchpad_init(int card_num) {
+bool lp_parse_inquiry_reply(const uint8_t* msg, uint32_t size, LpDeviceInfo* info) {
+    static const uint8_t header[] = {0x06, 0x02, 0x00, 0x20, 0x29};
+
+    if (!msg || size != LP_INQUIRY_REPLY_SIZE) return false;
+    if (msg[0] != 0xF0 || msg[1] != 0x7E || msg[size - 1] != 0xF7) return false;
+    if (memcmp(msg + 3, header, sizeof(header)) != 0) return false;
+
+    uint16_t family = (uint16_t)(msg[8] | (msg[9] << 8));
+    if (family != LP_FAMILY_MINI_MK3) return false;
+
+    if (info) {
+        info->family = family;
+        info->version = ((uint32_t)msg[12] << 24) | ((uint32_t)msg[13] << 16) |
+                        ((uint32_t)msg[14] << 8) | msg[15];
+    }
+    return true;
+}
+
+LaunchpadController* launchpad_open(const char* device_path) {
+    if (!device_path) return NULL;
+
     LaunchpadController* lp = (LaunchpadController*)calloc(1, sizeof(LaunchpadController));
     if (!lp) return NULL;
 
-    // Try to open the MIDI device
-    snprintf(lp->device_path, sizeof(lp->device_path), "/dev/snd/midiC%dD0", card_num);
+    snprintf(lp->device_path, sizeof(lp->device_path), "%s", device_path);
 
     lp->fd = open(lp->device_path, O_RDWR | O_NONBLOCK);
     if (lp->fd < 0) {
@@ -40,6 +59,14 @@ LaunchpadController* launchpad_init(int card_num) {
     return lp;
 }
 
+LaunchpadController* launchpad_init(int card_num) {
+    // Try to open the MIDI device
+    char path[256];
+    snprintf(path, sizeof(path), "/dev/snd/midiC%dD0", card_num);
+
+    return launchpad_open(path);
+}
+
 void launchpad_cleanup(LaunchpadController* lp) {
     if (!lp) return;
 
@@ -89,7 +116,7 @@ bool launchpad_update_grid(LaunchpadController* lp, const GridSeqState* state) {
             uint8_t note = lp_grid_to_note(x, y);
             uint8_t color;
 
-            if (x == state->current_step) {
+            if (x == state_row_step(state, y)) {
                 // Current step - yellow if active, dim yellow if not
                 color = state->grid[x][y] ? LP_COLOR_YELLOW : LP_COLOR_GREEN_DIM;
             } else {
@@ -106,7 +133,7 @@ bool launchpad_update_grid(LaunchpadController* lp, const GridSeqState* state) {
     return true;
 }
 
-bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state) {
+bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state, const ControlMap* controls) {
     if (!lp || !state || lp->fd < 0) return false;
 
     uint8_t buffer[256];
@@ -117,23 +144,29 @@ bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state) {
     }
 
     bool grid_changed = false;
+    const ControlSurface surface = {0, GRID_SIZE, true};
 
     // Process MIDI messages
     for (ssize_t i = 0; i < bytes_read; ) {
         uint8_t status = buffer[i];
 
-        // Note On (0x90) or Note Off (0x80)
-        if ((status & 0xF0) == 0x90 || (status & 0xF0) == 0x80) {
+        // Note On/Off (0x80, 0x90) and Control Change (0xB0)
+        if ((status & 0xF0) == 0x90 || (status & 0xF0) == 0x80 || (status & 0xF0) == 0xB0) {
             if (i + 2 < bytes_read) {
-                uint8_t note = buffer[i + 1];
-                uint8_t velocity = buffer[i + 2];
+                const uint8_t* msg = &buffer[i];
+                bool pressed = false;
+                const ControlBinding* binding =
+                    controls ? controls_lookup(controls, msg, 3, state->shift, &pressed) : NULL;
 
+                if (binding) {
+                    grid_changed |= controls_apply(state, binding, pressed, &surface);
+                }
                 // Only process Note On with velocity > 0 (button press)
-                if ((status & 0xF0) == 0x90 && velocity > 0) {
+                else if ((status & 0xF0) == 0x90 && msg[2] > 0) {
                     // Check if it's a grid button (notes 11-88)
-                    if (note >= 11 && note <= 88) {
+                    if (msg[1] >= 11 && msg[1] <= 88) {
                         uint8_t x, y;
-                        lp_note_to_grid(note, &x, &y);
+                        lp_note_to_grid(msg[1], &x, &y);
 
                         if (x < GRID_SIZE && y < GRID_SIZE) {
                             state_toggle_step(state, x, y);
@@ -147,17 +180,6 @@ bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state) {
                 break;
             }
         }
-        // Control Change (0xB0)
-        else if ((status & 0xF0) == 0xB0) {
-            if (i + 2 < bytes_read) {
-                // uint8_t cc = buffer[i + 1];
-                // uint8_t value = buffer[i + 2];
-                // TODO: Handle top row and scene buttons
-                i += 3;
-            } else {
-                break;
-            }
-        }
         else {
             // Skip unknown message
             i++;
@@ -14,6 +14,7 @@
 #define GRID_SEQ_LAUNCHPAD_H
 
 #include "grid_seq/common.h"
+#include "controls.h"
 #include "state.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -35,6 +36,80 @@ static inline void lp_note_to_grid(uint8_t note, uint8_t* x, uint8_t* y) {
     *y = offset / 10;
 }
 
+// Tiling: several Launchpads form one larger editing surface. Surface
+// coordinates count pads from the bottom-left corner of the whole surface.
+#define LP_MAX_DEVICES 4
+
+typedef enum {
+    LP_LAYOUT_SINGLE = 0,  // One device, 8x8 (paged with the arrow buttons)
+    LP_LAYOUT_16X8 = 1,    // Two devices side by side, 16 steps x 8 notes
+    LP_LAYOUT_16X16 = 2    // Four devices in a square, 16 steps x 16 notes
+} LpLayout;
+
+// Position of one device's bottom-left pad on the surface
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} LpTile;
+
+static inline uint8_t lp_layout_devices(LpLayout layout) {
+    return layout == LP_LAYOUT_16X16 ? 4 : (layout == LP_LAYOUT_16X8 ? 2 : 1);
+}
+
+static inline uint8_t lp_layout_columns(LpLayout layout) {
+    return layout == LP_LAYOUT_SINGLE ? 8 : 16;
+}
+
+static inline uint8_t lp_layout_rows(LpLayout layout) {
+    return layout == LP_LAYOUT_16X16 ? 16 : 8;
+}
+
+// Devices fill the surface left to right, then bottom to top
+static inline LpTile lp_layout_tile(LpLayout layout, uint8_t device) {
+    LpTile tile;
+    tile.col = (uint8_t)((device % 2) * 8);
+    tile.row = (uint8_t)(layout == LP_LAYOUT_16X16 ? (device / 2) * 8 : 0);
+    return tile;
+}
+
+static inline uint8_t lp_surface_to_note(LpTile tile, uint8_t sx, uint8_t sy) {
+    return lp_grid_to_note(sx - tile.col, sy - tile.row);
+}
+
+// Returns false for notes outside the 8x8 pad area
+static inline bool lp_note_to_surface(LpTile tile, uint8_t note, uint8_t* sx, uint8_t* sy) {
+    if (note < 11 || note > 88) return false;
+
+    uint8_t x, y;
+    lp_note_to_grid(note, &x, &y);
+    if (x >= 8 || y >= 8) return false;
+
+    *sx = tile.col + x;
+    *sy = tile.row + y;
+    return true;
+}
+
+// Device Inquiry reply: F0 7E <device id> 06 02 <manufacturer 00 20 29>
+// <family 2 bytes> <model 2 bytes> <firmware version 4 bytes> F7
+#define LP_INQUIRY_REPLY_SIZE 17
+#define LP_FAMILY_MINI_MK3 0x0113  // Family bytes 13 01, LSB first
+
+typedef struct {
+    uint16_t family;
+    uint32_t version;   // Firmware version digits, e.g. 0x00040701 for 471
+} LpDeviceInfo;
+
+/**
+ * Decode a Device Inquiry reply from a Novation device.
+ * Real-time safe; used on the plugin's Launchpad inputs.
+ *
+ * @param msg Complete SysEx message, F0 to F7
+ * @param size Message size in bytes
+ * @param info Filled in when the reply comes from a Launchpad Mini Mk3
+ * @return true for a Launchpad Mini Mk3 reply
+ */
+bool lp_parse_inquiry_reply(const uint8_t* msg, uint32_t size, LpDeviceInfo* info);
+
 // Top row CCs (91-98)
 #define LP_TOP_CC_BASE 91
 
@@ -59,6 +134,13 @@ typedef struct LaunchpadController LaunchpadController;
  */
 LaunchpadController* launchpad_init(int card_num);
 
+/**
+ * Open a rawmidi device node (e.g. /dev/snd/midiC1D0) without probing it.
+ *
+ * @return Launchpad controller handle or NULL on error
+ */
+LaunchpadController* launchpad_open(const char* device_path);
+
 /**
  * Cleanup and close Launchpad connection.
  */
@@ -88,10 +170,12 @@ bool launchpad_set_led(LaunchpadController* lp, uint8_t note, uint8_t color);
 bool launchpad_update_grid(LaunchpadController* lp, const GridSeqState* state);
 
 /**
- * Poll for button presses and update grid state.
+ * Poll for button presses and update grid state. Buttons bound in the
+ * control map act on the state; other pads toggle steps.
  *
- * @return true if grid was modified
+ * @param controls Button bindings, or NULL to only edit steps
+ * @return true if grid or view state was modified
  */
-bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state);
+bool launchpad_poll_input(LaunchpadController* lp, GridSeqState* state, const ControlMap* controls);
 
 #endif // GRID_SEQ_LAUNCHPAD_H
@@ -0,0 +1,217 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "leds.h"
+#include "launchpad.h"
+
+#include <string.h>
+
+// Arrow CCs in slot order after the pads (same order as a full refresh)
+static const uint8_t s_cc_numbers[LED_CC_COUNT] = {93, 94, 91, 92};
+
+static bool s_state_equal(const LedState* a, const LedState* b) {
+    return a->base == b->base && a->style == b->style &&
+           (a->style == LED_STATIC || a->color == b->color);
+}
+
+void leds_init(LedShadow* leds) {
+    if (!leds) return;
+
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        leds->target[i].base = LP_COLOR_OFF;
+        leds->target[i].color = LP_COLOR_OFF;
+        leds->target[i].style = LED_STATIC;
+    }
+    leds->cursor = 0;
+    leds->urgent = 0;
+    leds_invalidate(leds);
+}
+
+void leds_invalidate(LedShadow* leds) {
+    if (!leds) return;
+
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        leds->sent[i].base = LED_UNKNOWN;
+        leds->sent[i].color = LED_UNKNOWN;
+        leds->sent[i].style = LED_STATIC;
+    }
+}
+
+void leds_set_pad(LedShadow* leds, uint8_t x, uint8_t y, uint8_t color) {
+    leds_set_pad_animated(leds, x, y, color, color, LED_STATIC);
+}
+
+void leds_set_pad_animated(LedShadow* leds, uint8_t x, uint8_t y,
+                           uint8_t base, uint8_t color, LedStyle style) {
+    if (!leds || x >= 8 || y >= 8) return;
+
+    LedState* state = &leds->target[x * 8 + y];
+    state->base = base;
+    state->color = color;
+    state->style = (uint8_t)style;
+}
+
+void leds_mark_urgent(LedShadow* leds, uint8_t x, uint8_t y) {
+    if (!leds || x >= 8 || y >= 8) return;
+    leds->urgent |= (uint64_t)1 << (x * 8 + y);
+}
+
+void leds_set_cc(LedShadow* leds, uint8_t cc, uint8_t color) {
+    if (!leds) return;
+
+    for (uint32_t i = 0; i < LED_CC_COUNT; i++) {
+        if (s_cc_numbers[i] == cc) {
+            LedState* state = &leds->target[LED_PAD_COUNT + i];
+            state->base = color;
+            state->color = color;
+            state->style = LED_STATIC;
+            return;
+        }
+    }
+}
+
+uint32_t leds_pending(const LedShadow* leds) {
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < LED_COUNT; i++) {
+        if (!s_state_equal(&leds->target[i], &leds->sent[i])) pending++;
+    }
+    return pending;
+}
+
+// One LED message; the style selects the MIDI channel
+static bool s_write_led(LV2_Atom_Forge* forge, const SequencerURIDs* uris,
+                        uint32_t slot, uint8_t color, uint8_t style) {
+    uint8_t msg[3];
+    if (slot < LED_PAD_COUNT) {
+        // Pads are Note On with velocity = color
+        msg[0] = (uint8_t)(0x90 | style);
+        msg[1] = lp_grid_to_note((uint8_t)(slot / 8), (uint8_t)(slot % 8));
+    } else {
+        msg[0] = (uint8_t)(0xB0 | style);
+        msg[1] = s_cc_numbers[slot - LED_PAD_COUNT];
+    }
+    msg[2] = color;
+
+    return sequencer_write_midi(forge, uris, 0, msg, 3);
+}
+
+typedef enum {
+    FLUSH_SENT,
+    FLUSH_NO_BUDGET,
+    FLUSH_NO_SPACE
+} FlushResult;
+
+// Bring one slot up to date. Only the newest target is ever sent, so
+// changes made while a slot waits are coalesced into one update.
+static FlushResult s_flush_slot(LedShadow* leds, LV2_Atom_Forge* forge,
+                                const SequencerURIDs* uris, uint32_t i, uint32_t* budget) {
+    const LedState* target = &leds->target[i];
+    LedState* sent = &leds->sent[i];
+
+    // A static message sets the base and stops any animation, so it is
+    // needed for a new base or to end a flash or pulse
+    bool need_base = target->base != sent->base ||
+                     (target->style == LED_STATIC && sent->style != LED_STATIC);
+    uint32_t needed = need_base ? 1 : 0;
+    if (target->style != LED_STATIC) needed++;
+
+    if (*budget < needed) return FLUSH_NO_BUDGET;
+
+    if (need_base) {
+        if (!s_write_led(forge, uris, i, target->base, LED_STATIC)) return FLUSH_NO_SPACE;
+        sent->base = target->base;
+        sent->style = LED_STATIC;
+        (*budget)--;
+    }
+    if (target->style != LED_STATIC) {
+        if (!s_write_led(forge, uris, i, target->color, target->style)) return FLUSH_NO_SPACE;
+        sent->color = target->color;
+        sent->style = target->style;
+        (*budget)--;
+    }
+    return FLUSH_SENT;
+}
+
+uint32_t leds_flush(LedShadow* leds, LV2_Atom_Forge* forge, const SequencerURIDs* uris,
+                    uint32_t* budget) {
+    if (!leds || !forge || !uris || !budget) return 0;
+
+    uint32_t deferred = 0;
+    bool stopped = false;
+
+    // Urgent pads first, ahead of any background refresh
+    for (uint32_t i = 0; i < LED_PAD_COUNT && leds->urgent && !stopped; i++) {
+        const uint64_t bit = (uint64_t)1 << i;
+        if (!(leds->urgent & bit)) continue;
+
+        if (!s_state_equal(&leds->target[i], &leds->sent[i])) {
+            FlushResult result = s_flush_slot(leds, forge, uris, i, budget);
+            if (result == FLUSH_NO_BUDGET) return deferred;
+            if (result == FLUSH_NO_SPACE) {
+                stopped = true;
+                deferred++;
+                continue;
+            }
+        }
+        leds->urgent &= ~bit;
+    }
+
+    for (uint32_t n = 0; n < LED_COUNT; n++) {
+        uint32_t i = (leds->cursor + n) % LED_COUNT;
+        if (s_state_equal(&leds->target[i], &leds->sent[i])) continue;
+
+        if (stopped) {
+            // Buffer full: count what is left
+            deferred++;
+            continue;
+        }
+
+        FlushResult result = s_flush_slot(leds, forge, uris, i, budget);
+        if (result == FLUSH_NO_BUDGET) {
+            leds->cursor = (uint8_t)i;
+            break;
+        }
+        if (result == FLUSH_NO_SPACE) {
+            // Remember where to resume
+            leds->cursor = (uint8_t)i;
+            stopped = true;
+            deferred++;
+        }
+    }
+
+    return deferred;
+}
+
+void leds_bucket_init(LedBucket* bucket, double rate, double depth) {
+    if (!bucket) return;
+
+    bucket->rate = rate;
+    bucket->depth = depth;
+    bucket->tokens = depth;
+}
+
+void leds_bucket_refill(LedBucket* bucket, uint32_t n_frames, double sample_rate) {
+    if (!bucket || sample_rate <= 0.0) return;
+
+    bucket->tokens += bucket->rate * n_frames / sample_rate;
+    if (bucket->tokens > bucket->depth) bucket->tokens = bucket->depth;
+}
+
+uint32_t leds_bucket_available(const LedBucket* bucket) {
+    if (!bucket || bucket->tokens < 1.0) return 0;
+    return (uint32_t)bucket->tokens;
+}
+
+void leds_bucket_take(LedBucket* bucket, uint32_t packets) {
+    if (!bucket) return;
+    bucket->tokens -= packets;
+}
@@ -0,0 +1,157 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_LEDS_H
+#define GRID_SEQ_LEDS_H
+
+#include "sequencer.h"
+#include <stdint.h>
+
+// Launchpad LED shadow.
+//
+// run() sets the wanted color of every LED in target; leds_flush() sends
+// only the LEDs whose target differs from what was last sent, as far as
+// the output buffer allows. LEDs that did not fit stay pending and go out
+// in later blocks.
+//
+// Besides a static color, an LED can flash or pulse on its own: the
+// Launchpad Mini Mk3 animates LEDs set on MIDI channel 2 (flashing between
+// the static color and the new one) and channel 3 (pulsing). Animated LEDs
+// cost no traffic until they change.
+//
+// A LedBucket models the bandwidth of the USB MIDI link to one device as a
+// token bucket counted in USB MIDI event packets (3 MIDI bytes each). The
+// bucket refills at the link rate and holds at most one burst; run() gives
+// leds_flush() only the packets the bucket holds, so the device's input
+// queue never backs up. Since pending changes are coalesced per LED, at
+// most two messages per LED are ever waiting, which bounds LED latency by
+// 2 * LED_COUNT / rate.
+
+#define LED_PAD_COUNT 64
+#define LED_CC_COUNT 4   // Arrow buttons CC 91-94
+#define LED_COUNT (LED_PAD_COUNT + LED_CC_COUNT)
+#define LED_UNKNOWN 0xFF // Device state not known, always resent
+
+// Animation styles, numbered like the MIDI channel (0-based) they use
+typedef enum {
+    LED_STATIC = 0,
+    LED_FLASH = 1,   // Alternates between base and color
+    LED_PULSE = 2    // Pulses color
+} LedStyle;
+
+typedef struct {
+    uint8_t base;    // Static color (channel 1)
+    uint8_t color;   // Flash or pulse color, unused for LED_STATIC
+    uint8_t style;   // LedStyle
+} LedState;
+
+typedef struct {
+    LedState target[LED_COUNT];  // Pads (x * 8 + y), then CCs 93, 94, 91, 92
+    LedState sent[LED_COUNT];
+    uint64_t urgent;             // Pads sent before all others (press feedback)
+    uint8_t cursor;              // Slot the next flush starts at
+} LedShadow;
+
+typedef struct {
+    double tokens;  // Packets that may be sent now; negative while in debt
+    double rate;    // Packets per second
+    double depth;   // Largest burst
+} LedBucket;
+
+/**
+ * Initialize with all LEDs off and the device state unknown.
+ */
+void leds_init(LedShadow* leds);
+
+/**
+ * Forget what the device shows, so the next flush sends a full frame
+ * (after Programmer mode is entered or the device was reset).
+ */
+void leds_invalidate(LedShadow* leds);
+
+/**
+ * Set the wanted color of a grid pad.
+ *
+ * @param x Pad column (0-7)
+ * @param y Pad row (0-7, bottom to top)
+ * @param color Palette index
+ */
+void leds_set_pad(LedShadow* leds, uint8_t x, uint8_t y, uint8_t color);
+
+/**
+ * Set a grid pad to flash or pulse, animated by the device.
+ *
+ * @param base Static color (flashing alternates between base and color)
+ * @param color Animation color
+ * @param style LED_FLASH or LED_PULSE (LED_STATIC shows base)
+ */
+void leds_set_pad_animated(LedShadow* leds, uint8_t x, uint8_t y,
+                           uint8_t base, uint8_t color, LedStyle style);
+
+/**
+ * Send a pad's next change ahead of the background refresh, e.g. the
+ * feedback for a pad that was just pressed.
+ */
+void leds_mark_urgent(LedShadow* leds, uint8_t x, uint8_t y);
+
+/**
+ * Set the wanted color of an arrow button (CC 91-94).
+ */
+void leds_set_cc(LedShadow* leds, uint8_t cc, uint8_t color);
+
+/**
+ * Number of LEDs whose target differs from the sent state.
+ */
+uint32_t leds_pending(const LedShadow* leds);
+
+/**
+ * Write pending LED changes as Note On (pads) and CC (arrows) messages.
+ * A changed LED takes one message, or two when a flash needs a new base.
+ *
+ * Urgent pads go first. The rest is sent round robin: sending stops when
+ * the budget is used up and resumes at the same slot next time, so a
+ * throttled device still gets every LED updated in turn.
+ *
+ * @param leds LED shadow
+ * @param forge Forge positioned inside the Launchpad output sequence
+ * @param uris URID mappings
+ * @param budget Messages that may be sent, decremented for each one
+ * @return Number of changes that did not fit into the buffer
+ */
+uint32_t leds_flush(LedShadow* leds, LV2_Atom_Forge* forge, const SequencerURIDs* uris,
+                    uint32_t* budget);
+
+/**
+ * Start a full bucket.
+ *
+ * @param rate Link rate in packets per second
+ * @param depth Largest burst in packets
+ */
+void leds_bucket_init(LedBucket* bucket, double rate, double depth);
+
+/**
+ * Add the packets the link drains during one block.
+ */
+void leds_bucket_refill(LedBucket* bucket, uint32_t n_frames, double sample_rate);
+
+/**
+ * Whole packets that may be sent now.
+ */
+uint32_t leds_bucket_available(const LedBucket* bucket);
+
+/**
+ * Account for packets sent. SysEx and other traffic to the device is
+ * charged too, which may leave the bucket in debt for a while.
+ */
+void leds_bucket_take(LedBucket* bucket, uint32_t packets);
+
+#endif // GRID_SEQ_LEDS_H
@@ -0,0 +1,127 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "midi_clock.h"
+
+#include <string.h>
+
+void midi_clock_init(MidiClock* clock) {
+    if (!clock) return;
+    memset(clock, 0, sizeof(*clock));
+}
+
+static uint64_t s_frames_per_beat(const GridSeqState* state) {
+    const uint64_t steps = state->steps_per_beat ? state->steps_per_beat : DEFAULT_STEPS_PER_BEAT;
+    return state->frames_per_step * steps;
+}
+
+void midi_clock_enable(MidiClock* clock, const GridSeqState* state, bool enabled) {
+    if (!clock || !state || enabled == clock->enabled) return;
+
+    if (!enabled) {
+        midi_clock_stop(clock);
+        clock->enabled = false;
+        return;
+    }
+
+    clock->enabled = true;
+    if (state->playing) {
+        // Pick up where the sequence is
+        const uint64_t fpb = s_frames_per_beat(state);
+        midi_clock_start(clock, fpb ? (double)state->frame_counter / (double)fpb : 0.0);
+    }
+}
+
+void midi_clock_start(MidiClock* clock, double beat) {
+    if (!clock || !clock->enabled) return;
+
+    const double sixteenths = beat * 4.0 + 0.5;
+    if (beat <= 0.0 || sixteenths < 1.0) {
+        clock->cue = CLOCK_CUE_START;
+        clock->song_position = 0;
+    } else {
+        clock->cue = CLOCK_CUE_CONTINUE;
+        clock->song_position = sixteenths < CLOCK_SPP_MAX ? (uint16_t)sixteenths : CLOCK_SPP_MAX;
+    }
+    clock->running = true;
+    clock->next_tick = 0;
+}
+
+void midi_clock_stop(MidiClock* clock) {
+    if (!clock || !clock->running) return;
+
+    clock->cue = CLOCK_CUE_STOP;
+    clock->running = false;
+}
+
+uint64_t midi_clock_tick_frame(const GridSeqState* state, uint64_t tick) {
+    return tick * s_frames_per_beat(state) / CLOCK_PPQN;
+}
+
+void midi_clock_seek(MidiClock* clock, const GridSeqState* state, uint64_t frame) {
+    if (!clock || !state) return;
+
+    const uint64_t fpb = s_frames_per_beat(state);
+    clock->next_tick = fpb ? (frame * CLOCK_PPQN + fpb - 1) / fpb : 0;
+}
+
+uint64_t midi_clock_next_frame(const MidiClock* clock, const GridSeqState* state) {
+    if (!clock || !state || !clock->running) return UINT64_MAX;
+    return midi_clock_tick_frame(state, clock->next_tick);
+}
+
+uint32_t midi_clock_due(const MidiClock* clock, const GridSeqState* state, uint64_t until) {
+    if (!clock || !state) return 0;
+
+    uint32_t due = clock->cue == CLOCK_CUE_CONTINUE ? 2 : (clock->cue ? 1 : 0);
+    if (clock->running) {
+        for (uint64_t tick = clock->next_tick; midi_clock_tick_frame(state, tick) < until; tick++) {
+            due++;
+        }
+    }
+    return due;
+}
+
+uint32_t midi_clock_write_cue(MidiClock* clock, LV2_Atom_Forge* forge,
+                              const SequencerURIDs* uris, uint32_t frame_offset) {
+    if (!clock || !forge || !uris || clock->cue == CLOCK_CUE_NONE) return 0;
+
+    uint32_t dropped = 0;
+    if (clock->cue == CLOCK_CUE_CONTINUE) {
+        const uint8_t spp[3] = {
+            MIDI_SONG_POSITION,
+            (uint8_t)(clock->song_position & 0x7F),
+            (uint8_t)((clock->song_position >> 7) & 0x7F)
+        };
+        if (!sequencer_write_midi(forge, uris, frame_offset, spp, 3)) dropped++;
+    }
+
+    const uint8_t status = clock->cue == CLOCK_CUE_START ? MIDI_CLOCK_START
+                         : clock->cue == CLOCK_CUE_CONTINUE ? MIDI_CLOCK_CONTINUE
+                         : MIDI_CLOCK_STOP;
+    if (!sequencer_write_midi(forge, uris, frame_offset, &status, 1)) dropped++;
+
+    clock->cue = CLOCK_CUE_NONE;
+    return dropped;
+}
+
+bool midi_clock_write_tick(MidiClock* clock, const GridSeqState* state,
+                           LV2_Atom_Forge* forge, const SequencerURIDs* uris,
+                           uint64_t block_start) {
+    if (!clock || !state || !forge || !uris) return false;
+
+    const uint64_t frame = midi_clock_tick_frame(state, clock->next_tick++);
+    const uint32_t offset = frame > block_start ? (uint32_t)(frame - block_start) : 0;
+    const uint8_t tick = MIDI_CLOCK_TICK;
+    return sequencer_write_midi(forge, uris, offset, &tick, 1);
+}
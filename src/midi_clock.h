@@ -0,0 +1,117 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_MIDI_CLOCK_H
+#define GRID_SEQ_MIDI_CLOCK_H
+
+#include "sequencer.h"
+#include "state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// MIDI beat clock out: 24 ticks per quarter note with Start, Stop,
+// Continue and Song Position Pointer, for outboard gear.
+//
+// Ticks come from the same frame clock the sequencer steps on: tick n is
+// at frame n * frames_per_beat / 24, with frames_per_beat the integer
+// frames_per_step times steps_per_beat, so ticks and steps never drift
+// apart. Every block looks its first tick up again from its start frame,
+// so a tempo change moves the next tick without a burst of catch-up ticks.
+
+#define CLOCK_PPQN 24
+#define CLOCK_SPP_MAX 16383  // Song Position Pointer is 14 bits of sixteenths
+
+#define MIDI_CLOCK_TICK 0xF8
+#define MIDI_CLOCK_START 0xFA
+#define MIDI_CLOCK_CONTINUE 0xFB
+#define MIDI_CLOCK_STOP 0xFC
+#define MIDI_SONG_POSITION 0xF2
+
+typedef enum {
+    CLOCK_CUE_NONE = 0,
+    CLOCK_CUE_START,
+    CLOCK_CUE_CONTINUE,  // Song Position Pointer, then Continue
+    CLOCK_CUE_STOP
+} ClockCue;
+
+typedef struct {
+    bool enabled;
+    bool running;            // Start or Continue sent, no Stop since
+    uint8_t cue;             // ClockCue sent at the start of the next block
+    uint16_t song_position;  // Sixteenths, sent ahead of Continue
+    uint64_t next_tick;      // Index of the next tick, counted from frame 0
+} MidiClock;
+
+/**
+ * Initialize a disabled, stopped clock.
+ */
+void midi_clock_init(MidiClock* clock);
+
+/**
+ * Enable or disable the output. Disabling a running clock sends Stop;
+ * enabling it while the transport plays continues from the position.
+ */
+void midi_clock_enable(MidiClock* clock, const GridSeqState* state, bool enabled);
+
+/**
+ * The transport started at frame 0 of the sequence.
+ *
+ * @param beat Host song position in beats, 0 (or less) to Start
+ *        from the top; later positions send Song Position and Continue
+ */
+void midi_clock_start(MidiClock* clock, double beat);
+
+/**
+ * The transport stopped: send Stop.
+ */
+void midi_clock_stop(MidiClock* clock);
+
+/**
+ * Frame of a tick on the sequencer's clock.
+ */
+uint64_t midi_clock_tick_frame(const GridSeqState* state, uint64_t tick);
+
+/**
+ * Find the first tick at or after a block's start frame.
+ */
+void midi_clock_seek(MidiClock* clock, const GridSeqState* state, uint64_t frame);
+
+/**
+ * Frame of the next tick, UINT64_MAX while not running.
+ */
+uint64_t midi_clock_next_frame(const MidiClock* clock, const GridSeqState* state);
+
+/**
+ * Number of events due before a frame, cue included, to reserve space.
+ */
+uint32_t midi_clock_due(const MidiClock* clock, const GridSeqState* state, uint64_t until);
+
+/**
+ * Write the pending cue at frame_offset.
+ *
+ * @return Number of messages that did not fit (the cue is dropped)
+ */
+uint32_t midi_clock_write_cue(MidiClock* clock, LV2_Atom_Forge* forge,
+                              const SequencerURIDs* uris, uint32_t frame_offset);
+
+/**
+ * Write the next tick at its frame and move on to the one after.
+ *
+ * @param block_start Absolute frame of the block's first sample
+ * @return false if it did not fit (the tick is skipped)
+ */
+bool midi_clock_write_tick(MidiClock* clock, const GridSeqState* state,
+                           LV2_Atom_Forge* forge, const SequencerURIDs* uris,
+                           uint64_t block_start);
+
+#endif // GRID_SEQ_MIDI_CLOCK_H
@@ -0,0 +1,94 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "pattern_file.h"
+#include <string.h>
+
+#define PATTERN_FILE_MAGIC "grid-seq-pattern"
+#define PATTERN_FILE_VERSION 2  // Version 1 files have no row lines
+
+GridSeqError pattern_file_write(FILE* file, const GridSeqState* state) {
+    if (!file || !state) return GS_ERROR_NULL_POINTER;
+
+    fprintf(file, "%s %d\n", PATTERN_FILE_MAGIC, PATTERN_FILE_VERSION);
+    fprintf(file, "length %d\n", state->sequence_length);
+    fprintf(file, "steps_per_beat %d\n", state->steps_per_beat);
+
+    for (int note = 0; note < GRID_PITCH_RANGE; note++) {
+        if (state->row_length[note]) {
+            fprintf(file, "row %d %d\n", note, state->row_length[note]);
+        }
+    }
+
+    for (int x = 0; x < MAX_GRID_SIZE; x++) {
+        for (int note = 0; note < GRID_PITCH_RANGE; note++) {
+            if (state->grid[x][note]) {
+                fprintf(file, "cell %d %d\n", x, note);
+            }
+            if (state_ratchet(state, (uint8_t)x, (uint8_t)note) > 1) {
+                fprintf(file, "ratchet %d %d %d\n", x, note, state_ratchet(state, (uint8_t)x, (uint8_t)note));
+            }
+        }
+    }
+
+    return ferror(file) ? GS_ERROR_INVALID_PARAM : GS_OK;
+}
+
+GridSeqError pattern_file_read(FILE* file, GridSeqState* state) {
+    if (!file || !state) return GS_ERROR_NULL_POINTER;
+
+    char line[128];
+    int version = 0;
+
+    if (!fgets(line, sizeof(line), file) ||
+        sscanf(line, PATTERN_FILE_MAGIC " %d", &version) != 1 ||
+        version < 1 || version > PATTERN_FILE_VERSION) {
+        return GS_ERROR_INVALID_PARAM;
+    }
+
+    memset(state->grid, 0, sizeof(state->grid));
+    memset(state->row_length, 0, sizeof(state->row_length));
+    memset(state->ratchet, 0, sizeof(state->ratchet));
+
+    while (fgets(line, sizeof(line), file)) {
+        int a, b, c;
+
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        } else if (sscanf(line, "cell %d %d", &a, &b) == 2) {
+            if (a < 0 || a >= MAX_GRID_SIZE || b < 0 || b >= GRID_PITCH_RANGE) {
+                return GS_ERROR_INVALID_PARAM;
+            }
+            state->grid[a][b] = true;
+        } else if (sscanf(line, "ratchet %d %d %d", &a, &b, &c) == 3) {
+            if (a < 0 || a >= MAX_GRID_SIZE || b < 0 || b >= GRID_PITCH_RANGE || c < 1 || c > MAX_RATCHET) {
+                return GS_ERROR_INVALID_PARAM;
+            }
+            state_set_ratchet(state, (uint8_t)a, (uint8_t)b, (uint8_t)c);
+        } else if (sscanf(line, "row %d %d", &a, &b) == 2) {
+            if (a < 0 || a >= GRID_PITCH_RANGE || b < 1 || b > MAX_SEQUENCE_LENGTH) {
+                return GS_ERROR_INVALID_PARAM;
+            }
+            state->row_length[a] = (uint8_t)b;
+        } else if (sscanf(line, "length %d", &a) == 1) {
+            if (a < MIN_SEQUENCE_LENGTH || a > MAX_SEQUENCE_LENGTH) return GS_ERROR_INVALID_PARAM;
+            state->sequence_length = (uint8_t)a;
+        } else if (sscanf(line, "steps_per_beat %d", &a) == 1) {
+            if (a < 1 || a > MAX_STEPS_PER_BEAT) return GS_ERROR_INVALID_PARAM;
+            state->steps_per_beat = (uint8_t)a;
+        } else {
+            return GS_ERROR_INVALID_PARAM;
+        }
+    }
+
+    return GS_OK;
+}
@@ -0,0 +1,45 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_PATTERN_FILE_H
+#define GRID_SEQ_PATTERN_FILE_H
+
+#include "state.h"
+#include <stdio.h>
+
+// Plain-text pattern files (.gsp) used by the command-line tools:
+//
+//   grid-seq-pattern 2
+//   length 16
+//   steps_per_beat 1
+//   row <note> <length>     (rows with their own loop length, version 2)
+//   cell <step> <note>
+//   ratchet <step> <note> <hits>   (cells that retrigger, version 2)
+//   ...
+
+/**
+ * Write the pattern part of a state (grid, length, resolution, row lengths,
+ * ratchets).
+ *
+ * @return GS_OK on success
+ */
+GridSeqError pattern_file_write(FILE* file, const GridSeqState* state);
+
+/**
+ * Read a pattern into a state initialized with state_init().
+ * Call state_update_tempo() afterwards, as steps_per_beat may change.
+ *
+ * @return GS_OK on success, GS_ERROR_INVALID_PARAM on malformed input
+ */
+GridSeqError pattern_file_read(FILE* file, GridSeqState* state);
+
+#endif // GRID_SEQ_PATTERN_FILE_H
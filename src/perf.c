@@ -0,0 +1,165 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "perf.h"
+
+#include <string.h>
+#include <time.h>
+
+// Upper bound of a perfStats object: 12 properties and 6 vectors
+#define PERF_OBJECT_MAX_SIZE 512
+
+// Single-writer updates: a plain read-modify-write with atomic accesses
+// keeps readers tear-free per field without locked instructions
+static void s_add32(uint32_t* field, uint32_t value) {
+    __atomic_store_n(field, __atomic_load_n(field, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static void s_add64(uint64_t* field, uint64_t value) {
+    __atomic_store_n(field, __atomic_load_n(field, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static void s_max32(uint32_t* field, uint32_t value) {
+    if (value > __atomic_load_n(field, __ATOMIC_RELAXED)) {
+        __atomic_store_n(field, value, __ATOMIC_RELAXED);
+    }
+}
+
+static uint32_t s_load32(const uint32_t* field) {
+    return __atomic_load_n(field, __ATOMIC_RELAXED);
+}
+
+static uint32_t s_run_bucket(uint64_t ns) {
+    uint64_t units = ns >> 10;
+    if (units == 0) return 0;
+
+    uint32_t bucket = 64u - (uint32_t)__builtin_clzll(units);
+    return bucket < PERF_RUN_BUCKETS ? bucket : PERF_RUN_BUCKETS - 1;
+}
+
+void perf_init(PerfCounters* perf, double sample_rate) {
+    if (!perf) return;
+
+    memset(perf, 0, sizeof(PerfCounters));
+    perf->interval_frames = (uint64_t)(sample_rate * PERF_PUBLISH_INTERVAL);
+}
+
+uint64_t perf_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void perf_record_block(PerfCounters* perf, uint32_t n_samples, uint64_t run_ns, uint32_t step_boundaries) {
+    uint32_t clamped_ns = run_ns > UINT32_MAX ? UINT32_MAX : (uint32_t)run_ns;
+    uint32_t step_bucket = step_boundaries < PERF_STEP_BUCKETS ? step_boundaries : PERF_STEP_BUCKETS - 1;
+
+    s_add32(&perf->blocks, 1);
+    s_add64(&perf->frames, n_samples);
+    s_add64(&perf->run_ns_total, run_ns);
+    s_max32(&perf->run_ns_max, clamped_ns);
+    s_add32(&perf->run_ns_hist[s_run_bucket(run_ns)], 1);
+    s_add32(&perf->step_hist[step_bucket], 1);
+}
+
+void perf_record_port(PerfCounters* perf, PerfPort port, uint32_t events, uint32_t bytes_used, uint32_t capacity) {
+    s_add32(&perf->events[port], events);
+    s_max32(&perf->high_water[port], bytes_used);
+    __atomic_store_n(&perf->capacity[port], capacity, __ATOMIC_RELAXED);
+}
+
+void perf_record_overflow(PerfCounters* perf, PerfPort port, uint32_t count) {
+    s_add32(&perf->overflows[port], count);
+}
+
+void perf_record_log_dropped(PerfCounters* perf, uint32_t count) {
+    s_add32(&perf->log_dropped, count);
+}
+
+bool perf_publish_due(const PerfCounters* perf) {
+    return __atomic_load_n(&perf->frames, __ATOMIC_RELAXED) >= perf->interval_frames;
+}
+
+static void s_write_vector(LV2_Atom_Forge* forge, const PerfURIDs* uris, LV2_URID key,
+                           const uint32_t* values, uint32_t count) {
+    int32_t elems[PERF_RUN_BUCKETS];
+    for (uint32_t i = 0; i < count; i++) {
+        elems[i] = (int32_t)s_load32(&values[i]);
+    }
+
+    lv2_atom_forge_key(forge, key);
+    lv2_atom_forge_vector(forge, sizeof(int32_t), uris->atom_Int, count, elems);
+}
+
+bool perf_write(const PerfCounters* perf, LV2_Atom_Forge* forge, const PerfURIDs* uris,
+                double sample_rate, uint32_t frame) {
+    // Only start the object if all of it fits, so the sequence stays valid
+    if (forge->offset + sizeof(LV2_Atom_Event) + PERF_OBJECT_MAX_SIZE > forge->size) {
+        return false;
+    }
+
+    uint32_t blocks = s_load32(&perf->blocks);
+    uint64_t frames = __atomic_load_n(&perf->frames, __ATOMIC_RELAXED);
+    uint64_t run_ns_total = __atomic_load_n(&perf->run_ns_total, __ATOMIC_RELAXED);
+    double audio_ns = (double)frames / sample_rate * 1e9;
+
+    LV2_Atom_Forge_Frame obj;
+    lv2_atom_forge_frame_time(forge, frame);
+    lv2_atom_forge_object(forge, &obj, 0, uris->perfStats);
+
+    lv2_atom_forge_key(forge, uris->perfBlocks);
+    lv2_atom_forge_int(forge, (int32_t)blocks);
+    lv2_atom_forge_key(forge, uris->perfFrames);
+    lv2_atom_forge_long(forge, (int64_t)frames);
+    lv2_atom_forge_key(forge, uris->perfRunNsMean);
+    lv2_atom_forge_int(forge, blocks ? (int32_t)(run_ns_total / blocks) : 0);
+    lv2_atom_forge_key(forge, uris->perfRunNsMax);
+    lv2_atom_forge_int(forge, (int32_t)s_load32(&perf->run_ns_max));
+    lv2_atom_forge_key(forge, uris->perfDspLoad);
+    lv2_atom_forge_float(forge, audio_ns > 0.0 ? (float)(run_ns_total / audio_ns) : 0.0f);
+
+    s_write_vector(forge, uris, uris->perfRunNsHist, perf->run_ns_hist, PERF_RUN_BUCKETS);
+    s_write_vector(forge, uris, uris->perfStepHist, perf->step_hist, PERF_STEP_BUCKETS);
+    s_write_vector(forge, uris, uris->perfEvents, perf->events, PERF_NUM_PORTS);
+    s_write_vector(forge, uris, uris->perfHighWater, perf->high_water, PERF_NUM_PORTS);
+    s_write_vector(forge, uris, uris->perfCapacity, perf->capacity, PERF_NUM_PORTS);
+    s_write_vector(forge, uris, uris->perfOverflows, perf->overflows, PERF_NUM_PORTS);
+
+    lv2_atom_forge_key(forge, uris->perfLogDropped);
+    lv2_atom_forge_int(forge, (int32_t)s_load32(&perf->log_dropped));
+
+    lv2_atom_forge_pop(forge, &obj);
+    return true;
+}
+
+void perf_reset(PerfCounters* perf) {
+    // Field-wise stores keep concurrent readers tear-free; interval length
+    // and last known capacities carry over
+    __atomic_store_n(&perf->blocks, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&perf->frames, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&perf->run_ns_total, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&perf->run_ns_max, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&perf->log_dropped, 0, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < PERF_RUN_BUCKETS; i++) {
+        __atomic_store_n(&perf->run_ns_hist[i], 0, __ATOMIC_RELAXED);
+    }
+    for (uint32_t i = 0; i < PERF_STEP_BUCKETS; i++) {
+        __atomic_store_n(&perf->step_hist[i], 0, __ATOMIC_RELAXED);
+    }
+    for (uint32_t i = 0; i < PERF_NUM_PORTS; i++) {
+        __atomic_store_n(&perf->events[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&perf->high_water[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&perf->overflows[i], 0, __ATOMIC_RELAXED);
+    }
+}
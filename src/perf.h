@@ -0,0 +1,135 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_PERF_H
+#define GRID_SEQ_PERF_H
+
+#include <lv2/atom/forge.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Per-block performance counters.
+//
+// The audio thread is the only writer. Every field is stored with relaxed
+// atomics, so another thread may read a (slightly torn across fields, but
+// never locked) snapshot at any time. Counters cover one publish interval
+// and are written to the notify port as a perfStats object, then reset.
+
+#define PERF_RUN_BUCKETS 16        // run() duration histogram buckets
+#define PERF_STEP_BUCKETS 4        // Blocks with 0, 1, 2, 3+ step boundaries
+#define PERF_PUBLISH_INTERVAL 0.5  // Seconds of audio between publications
+
+typedef enum {
+    PERF_PORT_MIDI_OUT = 0,
+    PERF_PORT_LAUNCHPAD_OUT,
+    PERF_PORT_NOTIFY,
+    PERF_NUM_PORTS
+} PerfPort;
+
+typedef struct {
+    uint64_t interval_frames;   // Publish after this many frames
+
+    uint32_t blocks;
+    uint64_t frames;
+    uint64_t run_ns_total;
+    uint32_t run_ns_max;
+    // Bucket 0 counts runs under 1024 ns, bucket i runs in
+    // [2^(i+9), 2^(i+10)) ns, the last bucket everything longer
+    uint32_t run_ns_hist[PERF_RUN_BUCKETS];
+    uint32_t step_hist[PERF_STEP_BUCKETS];
+
+    uint32_t events[PERF_NUM_PORTS];      // Events written
+    uint32_t high_water[PERF_NUM_PORTS];  // Most bytes used in one block
+    uint32_t capacity[PERF_NUM_PORTS];    // Buffer size of the last block
+    uint32_t overflows[PERF_NUM_PORTS];   // Events that did not fit
+    uint32_t log_dropped;                 // Diagnostic records lost
+} PerfCounters;
+
+typedef struct {
+    LV2_URID atom_Int;
+    LV2_URID atom_Long;
+    LV2_URID atom_Float;
+    LV2_URID perfStats;
+    LV2_URID perfBlocks;
+    LV2_URID perfFrames;
+    LV2_URID perfRunNsMean;
+    LV2_URID perfRunNsMax;
+    LV2_URID perfRunNsHist;
+    LV2_URID perfDspLoad;
+    LV2_URID perfStepHist;
+    LV2_URID perfEvents;
+    LV2_URID perfHighWater;
+    LV2_URID perfCapacity;
+    LV2_URID perfOverflows;
+    LV2_URID perfLogDropped;
+} PerfURIDs;
+
+/**
+ * Initialize counters for a sample rate.
+ */
+void perf_init(PerfCounters* perf, double sample_rate);
+
+/**
+ * Monotonic clock in nanoseconds (CLOCK_MONOTONIC, vDSO, real-time safe).
+ */
+uint64_t perf_now_ns(void);
+
+/**
+ * Record one run() call.
+ *
+ * @param perf Counters
+ * @param n_samples Block size
+ * @param run_ns Time spent in run()
+ * @param step_boundaries Step boundaries that fell inside the block
+ */
+void perf_record_block(PerfCounters* perf, uint32_t n_samples, uint64_t run_ns, uint32_t step_boundaries);
+
+/**
+ * Record the output of one atom port for the block.
+ *
+ * @param perf Counters
+ * @param port Output port
+ * @param events Events written
+ * @param bytes_used Sequence size including its header
+ * @param capacity Buffer size offered by the host
+ */
+void perf_record_port(PerfCounters* perf, PerfPort port, uint32_t events, uint32_t bytes_used, uint32_t capacity);
+
+/**
+ * Count events that were dropped because an output buffer was full.
+ */
+void perf_record_overflow(PerfCounters* perf, PerfPort port, uint32_t count);
+
+/**
+ * Count diagnostic log records that were dropped.
+ */
+void perf_record_log_dropped(PerfCounters* perf, uint32_t count);
+
+/**
+ * Check whether a full publish interval has been recorded.
+ */
+bool perf_publish_due(const PerfCounters* perf);
+
+/**
+ * Write the interval counters as a perfStats object event.
+ *
+ * @return true if the object fit into the forge buffer
+ */
+bool perf_write(const PerfCounters* perf, LV2_Atom_Forge* forge, const PerfURIDs* uris,
+                double sample_rate, uint32_t frame);
+
+/**
+ * Start a new interval.
+ */
+void perf_reset(PerfCounters* perf);
+
+#endif // GRID_SEQ_PERF_H
@@ -0,0 +1,156 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "render.h"
+
+#include <lv2/atom/util.h>
+#include <lv2/midi/midi.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+// The forge only maps a fixed set of URIs, so a constant table will do
+// and engines can be set up on any thread
+static const char* const s_uris[] = {
+    LV2_ATOM__Blank, LV2_ATOM__Bool, LV2_ATOM__Chunk, LV2_ATOM__Double,
+    LV2_ATOM__Float, LV2_ATOM__Int, LV2_ATOM__Long, LV2_ATOM__Literal,
+    LV2_ATOM__Object, LV2_ATOM__Path, LV2_ATOM__Property, LV2_ATOM__Resource,
+    LV2_ATOM__Sequence, LV2_ATOM__String, LV2_ATOM__Tuple, LV2_ATOM__URI,
+    LV2_ATOM__URID, LV2_ATOM__Vector, LV2_MIDI__MidiEvent,
+};
+
+static LV2_URID s_map(LV2_URID_Map_Handle handle, const char* uri) {
+    (void)handle;
+    for (size_t i = 0; i < sizeof(s_uris) / sizeof(s_uris[0]); i++) {
+        if (strcmp(s_uris[i], uri) == 0) return (LV2_URID)(i + 1);
+    }
+    return 0;
+}
+
+void render_init(RenderEngine* engine, const GridSeqState* pattern, double sample_rate,
+                 double bpm, uint32_t block_size, bool note_offs) {
+    if (!engine || !pattern) return;
+
+    LV2_URID_Map map = {NULL, s_map};
+    lv2_atom_forge_init(&engine->forge, &map);
+    engine->uris.midi_MidiEvent = s_map(NULL, LV2_MIDI__MidiEvent);
+
+    // Transport as activate() leaves it
+    engine->state = *pattern;
+    engine->state.sample_rate = sample_rate;
+    state_update_tempo(&engine->state, bpm);
+    engine->state.playing = true;
+    engine->state.frame_counter = 0;
+    engine->state.point_due = false;
+    engine->state.current_step = 0;
+    engine->state.previous_step = GRID_SIZE - 1;
+    engine->state.first_run = true;
+    memset(engine->state.active_notes, 0, sizeof(engine->state.active_notes));
+    sequencer_queue_clear(&engine->queue);
+
+    engine->block_size = block_size ? block_size : RENDER_DEFAULT_BLOCK;
+    engine->note_offs = note_offs;
+    engine->frame = 0;
+    engine->dropped = 0;
+}
+
+static bool s_append(RenderOutput* out, uint64_t frame, const uint8_t* msg, uint32_t size) {
+    if (out->count == out->capacity) {
+        const size_t capacity = out->capacity ? out->capacity * 2 : 1024;
+        RenderEvent* events = (RenderEvent*)realloc(out->events, capacity * sizeof(RenderEvent));
+        if (!events) return false;
+        out->events = events;
+        out->capacity = capacity;
+    }
+
+    RenderEvent* ev = &out->events[out->count++];
+    ev->frame = frame;
+    ev->size = (uint8_t)(size < sizeof(ev->msg) ? size : sizeof(ev->msg));
+    memcpy(ev->msg, msg, ev->size);
+    return true;
+}
+
+// One block, written the way run() writes midi_out
+static GridSeqError s_block(RenderEngine* engine, uint32_t n_samples, RenderOutput* out) {
+    GridSeqState* state = &engine->state;
+    LV2_Atom_Forge* forge = &engine->forge;
+    LV2_Atom_Forge_Frame frame;
+
+    lv2_atom_forge_set_buffer(forge, (uint8_t*)engine->buffer, sizeof(engine->buffer));
+    lv2_atom_forge_sequence_head(forge, &frame, 0);
+
+    SeqBlock block;
+    sequencer_begin_block(state, n_samples, n_samples, engine->note_offs, false, &block);
+
+    uint32_t dropped = 0;
+    if (block.play_step) {
+        dropped += sequencer_schedule_ratchets(state, &engine->queue, block.start, engine->note_offs);
+        dropped += sequencer_process_step(state, forge, &engine->uris, 0);
+    }
+    if (block.note_offs) {
+        dropped += sequencer_process_queue(&engine->queue, forge, &engine->uris,
+                                           block.start, block.half_point);
+        dropped += sequencer_process_note_offs(state, forge, &engine->uris,
+                                               (uint32_t)(block.half_point - block.start));
+    }
+
+    SeqPoint point;
+    while (block.by_points && sequencer_next_point(state, &block, &point)) {
+        dropped += sequencer_process_queue(&engine->queue, forge, &engine->uris, block.start, point.frame);
+        if (point.step) {
+            dropped += sequencer_schedule_ratchets(state, &engine->queue, point.frame, engine->note_offs);
+            dropped += sequencer_process_step(state, forge, &engine->uris, point.offset);
+        } else if (engine->note_offs) {
+            dropped += sequencer_process_note_offs(state, forge, &engine->uris, point.offset);
+        }
+    }
+    dropped += sequencer_process_queue(&engine->queue, forge, &engine->uris, block.start, block.end);
+    lv2_atom_forge_pop(forge, &frame);
+    engine->dropped += dropped;
+
+    const LV2_Atom_Sequence* seq = (const LV2_Atom_Sequence*)engine->buffer;
+    LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+        if (!s_append(out, engine->frame + (uint64_t)ev->time.frames,
+                      (const uint8_t*)(ev + 1), ev->body.size)) {
+            return GS_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    engine->frame += n_samples;
+    return GS_OK;
+}
+
+GridSeqError render_run(RenderEngine* engine, uint64_t frames, RenderOutput* out) {
+    if (!engine || !out) return GS_ERROR_NULL_POINTER;
+
+    while (frames) {
+        const uint32_t n = frames < engine->block_size ? (uint32_t)frames : engine->block_size;
+        GridSeqError err = s_block(engine, n, out);
+        if (err != GS_OK) return err;
+        frames -= n;
+    }
+    return GS_OK;
+}
+
+uint64_t render_step_frames(const RenderEngine* engine, uint32_t steps) {
+    return engine ? engine->state.frames_per_step * steps : 0;
+}
+
+void render_output_free(RenderOutput* out) {
+    if (!out) return;
+
+    free(out->events);
+    out->events = NULL;
+    out->count = 0;
+    out->capacity = 0;
+}
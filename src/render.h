@@ -0,0 +1,87 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_RENDER_H
+#define GRID_SEQ_RENDER_H
+
+#include "sequencer.h"
+#include "state.h"
+#include <stddef.h>
+
+// Offline rendering: a pattern played from transport start with the
+// plugin's own block timing (sequencer_begin_block() and the same step,
+// Note Off and ratchet writers), without a host. Rendered at the block
+// size a host runs the plugin with, the events match live playback
+// frame for frame.
+//
+// An engine holds all of its state, so engines on different threads
+// need no locking.
+
+#define RENDER_BUFFER_SIZE 65536  // MIDI output of one block, in bytes
+#define RENDER_DEFAULT_BLOCK 256
+
+typedef struct {
+    uint64_t frame;   // From transport start
+    uint8_t size;
+    uint8_t msg[3];
+} RenderEvent;
+
+typedef struct {
+    RenderEvent* events;
+    size_t count;
+    size_t capacity;
+} RenderOutput;
+
+typedef struct {
+    GridSeqState state;
+    SeqQueue queue;
+    SequencerURIDs uris;
+    LV2_Atom_Forge forge;
+    uint32_t block_size;
+    bool note_offs;
+    uint64_t frame;       // Frames rendered so far
+    uint32_t dropped;     // Events that did not fit into a block's buffer
+    uint64_t buffer[RENDER_BUFFER_SIZE / sizeof(uint64_t)];
+} RenderEngine;
+
+/**
+ * Set up an engine to play a pattern from its first step, as the plugin
+ * does after activation.
+ *
+ * @param pattern Pattern state (grid, lengths, ratchets, scale)
+ * @param sample_rate Output rate in Hz
+ * @param bpm Tempo
+ * @param block_size Frames per block, the host's block size to match it
+ * @param note_offs false for Note On only output (the MIDI filter)
+ */
+void render_init(RenderEngine* engine, const GridSeqState* pattern, double sample_rate,
+                 double bpm, uint32_t block_size, bool note_offs);
+
+/**
+ * Render the next frames and append their events to out.
+ *
+ * @return GS_OK, or GS_ERROR_OUT_OF_MEMORY if out cannot grow
+ */
+GridSeqError render_run(RenderEngine* engine, uint64_t frames, RenderOutput* out);
+
+/**
+ * Frames a number of steps takes at the engine's tempo.
+ */
+uint64_t render_step_frames(const RenderEngine* engine, uint32_t steps);
+
+/**
+ * Free the events of an output and empty it.
+ */
+void render_output_free(RenderOutput* out);
+
+#endif // GRID_SEQ_RENDER_H
@@ -0,0 +1,103 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "rtlog.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+// Number of conversions in a format string ("%%" is a literal percent)
+static int s_count_args(const char* format) {
+    int count = 0;
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') continue;
+        if (p[1] == '%') {
+            p++;
+        } else {
+            count++;
+        }
+    }
+    return count < RTLOG_MAX_ARGS ? count : RTLOG_MAX_ARGS;
+}
+
+void rtlog_init(RtLog* log) {
+    if (!log) return;
+    memset(log, 0, sizeof(RtLog));
+}
+
+void rtlog_set_muted(RtLog* log, bool muted) {
+    if (!log) return;
+    log->muted = muted;
+}
+
+bool rtlog_write(RtLog* log, const char* format, ...) {
+    if (!log || !format || log->muted) return false;
+
+    uint32_t write_pos = log->write_pos;
+    uint32_t read_pos = __atomic_load_n(&log->read_pos, __ATOMIC_ACQUIRE);
+    if (write_pos - read_pos >= RTLOG_CAPACITY) {
+        __atomic_add_fetch(&log->dropped, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&log->dropped_total, log->dropped_total + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    RtLogRecord* record = &log->records[write_pos & (RTLOG_CAPACITY - 1)];
+    record->format = format;
+    memset(record->args, 0, sizeof(record->args));
+
+    va_list args;
+    va_start(args, format);
+    int count = s_count_args(format);
+    for (int i = 0; i < count; i++) {
+        record->args[i] = va_arg(args, int);
+    }
+    va_end(args);
+
+    __atomic_store_n(&log->write_pos, write_pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t rtlog_dropped_total(const RtLog* log) {
+    return log ? __atomic_load_n(&log->dropped_total, __ATOMIC_RELAXED) : 0;
+}
+
+bool rtlog_pending(const RtLog* log) {
+    if (!log) return false;
+
+    return __atomic_load_n(&log->write_pos, __ATOMIC_ACQUIRE) != log->read_pos ||
+           __atomic_load_n(&log->dropped, __ATOMIC_RELAXED) != 0;
+}
+
+uint32_t rtlog_drain(RtLog* log, FILE* out) {
+    if (!log || !out) return 0;
+
+    uint32_t read_pos = log->read_pos;
+    uint32_t write_pos = __atomic_load_n(&log->write_pos, __ATOMIC_ACQUIRE);
+    uint32_t printed = 0;
+
+    while (read_pos != write_pos) {
+        const RtLogRecord* record = &log->records[read_pos & (RTLOG_CAPACITY - 1)];
+        fprintf(out, record->format,
+                record->args[0], record->args[1], record->args[2], record->args[3]);
+        fputc('\n', out);
+        read_pos++;
+        printed++;
+    }
+    __atomic_store_n(&log->read_pos, read_pos, __ATOMIC_RELEASE);
+
+    uint32_t dropped = __atomic_exchange_n(&log->dropped, 0, __ATOMIC_RELAXED);
+    if (dropped) {
+        fprintf(out, "grid-seq: %u log messages dropped\n", dropped);
+    }
+
+    return printed;
+}
@@ -0,0 +1,83 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_RTLOG_H
+#define GRID_SEQ_RTLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Real-time safe diagnostic log.
+//
+// run() must not call stdio, so messages are stored as a format string
+// pointer plus integer arguments in a single-producer/single-consumer ring.
+// Formatting happens later on a non-real-time thread (the LV2 worker).
+// When the ring is full, messages are dropped and counted.
+
+#define RTLOG_CAPACITY 256   // Records, must be a power of two
+#define RTLOG_MAX_ARGS 4
+
+typedef struct {
+    const char* format;
+    int32_t args[RTLOG_MAX_ARGS];
+} RtLogRecord;
+
+typedef struct {
+    RtLogRecord records[RTLOG_CAPACITY];
+    uint32_t write_pos;   // Written by the audio thread only
+    uint32_t read_pos;    // Written by the draining thread only
+    uint32_t dropped;     // Messages lost since the last drain
+    uint32_t dropped_total;
+    bool muted;           // Writes are discarded (not counted as dropped)
+} RtLog;
+
+/**
+ * Initialize an empty log.
+ */
+void rtlog_init(RtLog* log);
+
+/**
+ * Queue a message from the audio thread. Never blocks or allocates.
+ *
+ * @param log Log ring
+ * @param format String literal (must outlive the log) with at most
+ *        RTLOG_MAX_ARGS conversions, all of which take an int
+ * @return false if the ring was full and the message was dropped
+ */
+bool rtlog_write(RtLog* log, const char* format, ...);
+
+/**
+ * Discard messages instead of queueing them, e.g. while the host renders
+ * offline. Messages already queued are still drained.
+ */
+void rtlog_set_muted(RtLog* log, bool muted);
+
+/**
+ * Total number of messages dropped since rtlog_init().
+ */
+uint32_t rtlog_dropped_total(const RtLog* log);
+
+/**
+ * Check whether messages are waiting to be drained.
+ */
+bool rtlog_pending(const RtLog* log);
+
+/**
+ * Format and print all queued messages, plus a note about dropped ones.
+ * Must not be called from the audio thread.
+ *
+ * @return Number of messages printed
+ */
+uint32_t rtlog_drain(RtLog* log, FILE* out);
+
+#endif // GRID_SEQ_RTLOG_H
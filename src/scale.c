@@ -0,0 +1,57 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "scale.h"
+
+typedef struct {
+    const char* name;
+    uint8_t count;
+    uint8_t steps[12];  // Semitones above the root
+} ScaleDef;
+
+static const ScaleDef s_scales[SCALE_COUNT] = {
+    {"Chromatic", 12, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    {"Major", 7, {0, 2, 4, 5, 7, 9, 11}},
+    {"Minor", 7, {0, 2, 3, 5, 7, 8, 10}},
+    {"Harmonic Minor", 7, {0, 2, 3, 5, 7, 8, 11}},
+    {"Dorian", 7, {0, 2, 3, 5, 7, 9, 10}},
+    {"Mixolydian", 7, {0, 2, 4, 5, 7, 9, 10}},
+    {"Major Pentatonic", 5, {0, 2, 4, 7, 9}},
+    {"Minor Pentatonic", 5, {0, 3, 5, 7, 10}},
+    {"Blues", 6, {0, 3, 5, 6, 7, 10}},
+};
+
+void scale_build(uint8_t table[GRID_PITCH_RANGE], uint8_t scale, uint8_t key) {
+    if (!table) return;
+
+    const ScaleDef* def = &s_scales[scale < SCALE_COUNT ? scale : SCALE_CHROMATIC];
+    const int root = DEFAULT_PITCH_OFFSET + key % 12;
+
+    for (int row = 0; row < GRID_PITCH_RANGE; row++) {
+        // Degree relative to the root row, floored so rows below it count down
+        const int degree = row - DEFAULT_PITCH_OFFSET;
+        int octave = degree / def->count;
+        int index = degree % def->count;
+        if (index < 0) {
+            index += def->count;
+            octave--;
+        }
+
+        const int note = root + octave * 12 + def->steps[index];
+        table[row] = note >= 0 && note < GRID_PITCH_RANGE ? (uint8_t)note : SCALE_NO_NOTE;
+    }
+}
+
+const char* scale_name(uint8_t scale) {
+    return scale < SCALE_COUNT ? s_scales[scale].name : s_scales[SCALE_CHROMATIC].name;
+}
@@ -0,0 +1,57 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_SCALE_H
+#define GRID_SEQ_SCALE_H
+
+#include "grid_seq/common.h"
+
+// Scale mode: grid rows are scale degrees instead of semitones.
+//
+// A row's MIDI note comes from a 128-entry table built by scale_build()
+// whenever the key or scale changes, so the sequencer, the Launchpad view
+// and the UI all resolve rows with one lookup. DEFAULT_PITCH_OFFSET is
+// always the key's root in octave 2, so the default view stays put when
+// the scale changes. In the chromatic scale in C every row is its own
+// note, as before.
+
+#define SCALE_NO_NOTE 0xFF  // Row beyond the MIDI range in this scale
+
+typedef enum {
+    SCALE_CHROMATIC = 0,
+    SCALE_MAJOR = 1,
+    SCALE_MINOR = 2,
+    SCALE_HARMONIC_MINOR = 3,
+    SCALE_DORIAN = 4,
+    SCALE_MIXOLYDIAN = 5,
+    SCALE_PENTATONIC_MAJOR = 6,
+    SCALE_PENTATONIC_MINOR = 7,
+    SCALE_BLUES = 8,
+    SCALE_COUNT
+} ScaleType;
+
+/**
+ * Fill the row to note table for a scale and key.
+ *
+ * @param table Note per row, SCALE_NO_NOTE for rows outside 0-127
+ * @param scale ScaleType (out of range values give chromatic)
+ * @param key Root pitch class, 0 (C) to 11 (B)
+ */
+void scale_build(uint8_t table[GRID_PITCH_RANGE], uint8_t scale, uint8_t key);
+
+/**
+ * Display name of a scale, e.g. "Major".
+ */
+const char* scale_name(uint8_t scale);
+
+#endif // GRID_SEQ_SCALE_H
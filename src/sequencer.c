@@ -11,9 +11,63 @@
  */
 
 #include "sequencer.h"
-#include <stdio.h>
 
-static void s_send_midi_message(
+uint32_t sequencer_midi_event_size(uint32_t size) {
+    return (uint32_t)sizeof(LV2_Atom_Event) + ((size + 7u) & ~7u);
+}
+
+// Hits a note plays on a step, taking mutes and fill into account: 0 when
+// silent, more than 1 for a ratchet. Rows with their own loop length play
+// their own step instead. Rows the scale or the keyboard follow offset
+// put outside the MIDI range are silent.
+static uint8_t s_note_hits(const GridSeqState* state, uint8_t step, uint8_t note) {
+    if (state->muted[note] || state_output_note(state, note) == SCALE_NO_NOTE) return 0;
+    if (state->row_length[note]) step = state_row_step(state, note);
+    if (state->grid[step][note]) return state_ratchet(state, step, note);
+    if (!state->fill) return 0;
+
+    const uint8_t length = state_row_length(state, note);
+    for (uint8_t x = 0; x < length && x < MAX_GRID_SIZE; x++) {
+        if (state->grid[x][note]) return 1;
+    }
+    return 0;
+}
+
+uint32_t sequencer_step_note_count(const GridSeqState* state, uint8_t step) {
+    uint32_t count = 0;
+    for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+        if (s_note_hits(state, step, note) == 1) count++;
+    }
+    return count;
+}
+
+uint32_t sequencer_active_note_count(const GridSeqState* state) {
+    uint32_t count = 0;
+    for (uint8_t note = 0; note < 128; note++) {
+        if (state->active_notes[note]) count++;
+    }
+    return count;
+}
+
+bool sequencer_write_midi(
+    LV2_Atom_Forge* forge,
+    const SequencerURIDs* uris,
+    uint32_t frame_offset,
+    const uint8_t* msg,
+    uint32_t size
+) {
+    // Event header plus padded body must fit, or nothing is written
+    if (forge->offset + sequencer_midi_event_size(size) > forge->size) {
+        return false;
+    }
+
+    lv2_atom_forge_frame_time(forge, frame_offset);
+    lv2_atom_forge_atom(forge, size, uris->midi_MidiEvent);
+    lv2_atom_forge_write(forge, msg, size);
+    return true;
+}
+
+static bool s_send_midi_message(
     LV2_Atom_Forge* forge,
     const SequencerURIDs* uris,
     uint32_t frame_offset,
@@ -22,54 +76,295 @@ static void s_send_midi_message(
     uint8_t velocity
 ) {
     uint8_t midi_data[3] = {status, note, velocity};
-
-    fprintf(stderr, "grid-seq: MIDI OUTPUT - status=0x%02X note=%d vel=%d\n", status, note, velocity);
-
-    lv2_atom_forge_frame_time(forge, frame_offset);
-    lv2_atom_forge_atom(forge, 3, uris->midi_MidiEvent);
-    lv2_atom_forge_write(forge, midi_data, 3);
+    return sequencer_write_midi(forge, uris, frame_offset, midi_data, 3);
 }
 
-void sequencer_process_step(
+uint32_t sequencer_process_step(
     GridSeqState* state,
     LV2_Atom_Forge* forge,
     const SequencerURIDs* uris,
     uint32_t frame_offset
 ) {
-    if (!state || !forge || !uris) return;
+    if (!state || !forge || !uris) return 0;
+
+    uint32_t dropped = 0;
 
     // Send Note On for current step
     uint8_t x = state->current_step;
 
-    // Play all active notes across full MIDI range
-    for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
-        if (state->grid[x][note]) {
-            fprintf(stderr, "grid-seq: Step %d - SENDING NOTE ON: %d from grid[%d][%d]\n",
-                    x, note, x, note);
-            s_send_midi_message(forge, uris, frame_offset, 0x90, note, 100);
-            state->active_notes[note] = true;
+    // Play all active rows across full MIDI range, each on the note the
+    // scale and keyboard follow give it; ratchets are queued
+    for (uint8_t row = 0; row < GRID_PITCH_RANGE; row++) {
+        if (s_note_hits(state, x, row) == 1) {
+            const uint8_t note = state_output_note(state, row);
+            if (s_send_midi_message(forge, uris, frame_offset, 0x90, note, SEQ_NOTE_VELOCITY)) {
+                state->active_notes[note] = true;
+            } else {
+                dropped++;
+            }
         }
     }
 
     // Update previous step
     state->previous_step = state->current_step;
+    return dropped;
 }
 
-void sequencer_process_note_offs(
+uint32_t sequencer_process_note_offs(
     GridSeqState* state,
     LV2_Atom_Forge* forge,
     const SequencerURIDs* uris,
     uint32_t frame_offset
 ) {
-    if (!state || !forge || !uris) return;
+    if (!state || !forge || !uris) return 0;
+
+    uint32_t dropped = 0;
 
     // Send Note Off for all currently active notes
     for (uint8_t note = 0; note < 128; note++) {
         if (state->active_notes[note]) {
-            s_send_midi_message(forge, uris, frame_offset, 0x80, note, 0);
-            state->active_notes[note] = false;
+            if (s_send_midi_message(forge, uris, frame_offset, 0x80, note, 0)) {
+                state->active_notes[note] = false;
+            } else {
+                dropped++;
+            }
+        }
+    }
+
+    return dropped;
+}
+
+// Heap order: earlier frame first, and a Note Off before a Note On on the
+// same frame so a retrigger never cuts its own new note
+static bool s_event_before(const SeqEvent* a, const SeqEvent* b) {
+    if (a->frame != b->frame) return a->frame < b->frame;
+    return a->velocity == 0 && b->velocity != 0;
+}
+
+static void s_queue_push(SeqQueue* queue, uint64_t frame, uint8_t note, uint8_t velocity) {
+    uint32_t i = queue->count++;
+    const SeqEvent event = {frame, note, velocity};
+
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!s_event_before(&event, &queue->events[parent])) break;
+        queue->events[i] = queue->events[parent];
+        i = parent;
+    }
+    queue->events[i] = event;
+}
+
+static void s_queue_pop(SeqQueue* queue) {
+    const SeqEvent last = queue->events[--queue->count];
+    uint32_t i = 0;
+
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= queue->count) break;
+        if (child + 1 < queue->count &&
+            s_event_before(&queue->events[child + 1], &queue->events[child])) {
+            child++;
         }
+        if (!s_event_before(&queue->events[child], &last)) break;
+        queue->events[i] = queue->events[child];
+        i = child;
     }
+    if (queue->count) queue->events[i] = last;
+}
+
+void sequencer_queue_clear(SeqQueue* queue) {
+    if (queue) queue->count = 0;
+}
+
+uint32_t sequencer_schedule_ratchets(const GridSeqState* state, SeqQueue* queue,
+                                     uint64_t step_frame, bool note_offs) {
+    if (!state || !queue) return 0;
+
+    uint32_t dropped = 0;
+    for (uint8_t row = 0; row < GRID_PITCH_RANGE; row++) {
+        const uint8_t hits = s_note_hits(state, state->current_step, row);
+        if (hits < 2) continue;
+
+        const uint8_t note = state_output_note(state, row);
+        const uint64_t spacing = state->frames_per_step / hits;
+        const uint64_t gate = spacing / 2 ? spacing / 2 : 1;
+
+        for (uint8_t k = 0; k < hits; k++) {
+            // Each hit goes in with its Note Off, or not at all
+            if (queue->count + 2 > SEQ_QUEUE_SIZE) {
+                dropped += hits - k;
+                break;
+            }
+
+            const uint64_t frame = step_frame + k * spacing;
+            const uint8_t velocity = (uint8_t)(SEQ_RATCHET_VELOCITY_START +
+                (SEQ_NOTE_VELOCITY - SEQ_RATCHET_VELOCITY_START) * k / (hits - 1));
+            s_queue_push(queue, frame, note, velocity);
+            if (note_offs) s_queue_push(queue, frame + gate, note, 0);
+        }
+    }
+    return dropped;
+}
+
+uint32_t sequencer_queue_due(const SeqQueue* queue, uint64_t until) {
+    if (!queue) return 0;
+
+    uint32_t due = 0;
+    for (uint32_t i = 0; i < queue->count; i++) {
+        if (queue->events[i].frame < until) due++;
+    }
+    return due;
+}
+
+uint32_t sequencer_process_queue(SeqQueue* queue, LV2_Atom_Forge* forge,
+                                 const SequencerURIDs* uris,
+                                 uint64_t block_start, uint64_t until) {
+    if (!queue || !forge || !uris) return 0;
+
+    uint32_t dropped = 0;
+    while (queue->count && queue->events[0].frame < until) {
+        const SeqEvent* event = &queue->events[0];
+        const uint32_t offset = event->frame > block_start ? (uint32_t)(event->frame - block_start) : 0;
+        const uint8_t status = event->velocity ? 0x90 : 0x80;
+
+        if (!s_send_midi_message(forge, uris, offset, status, event->note, event->velocity)) {
+            dropped++;
+            if (!event->velocity) break;  // Retried next block
+        }
+        s_queue_pop(queue);
+    }
+    return dropped;
+}
+
+void sequencer_queue_restart(SeqQueue* queue) {
+    if (!queue) return;
+
+    // A Note Off after a queued Note On of its note belongs to a hit that
+    // never sounded
+    uint64_t first_on[GRID_PITCH_RANGE];
+    for (uint32_t note = 0; note < GRID_PITCH_RANGE; note++) {
+        first_on[note] = UINT64_MAX;
+    }
+    for (uint32_t i = 0; i < queue->count; i++) {
+        const SeqEvent* event = &queue->events[i];
+        if (event->velocity && event->frame < first_on[event->note]) {
+            first_on[event->note] = event->frame;
+        }
+    }
+
+    // Equal keys keep the array a valid heap
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < queue->count; i++) {
+        const SeqEvent* event = &queue->events[i];
+        if (!event->velocity && event->frame < first_on[event->note]) {
+            queue->events[kept] = queue->events[i];
+            queue->events[kept].frame = 0;
+            kept++;
+        }
+    }
+    queue->count = kept;
+}
+
+uint32_t sequencer_queue_release(SeqQueue* queue, LV2_Atom_Forge* forge,
+                                 const SequencerURIDs* uris, uint32_t frame_offset) {
+    if (!queue || !forge || !uris) return 0;
+
+    sequencer_queue_restart(queue);
+
+    uint32_t dropped = 0;
+    while (queue->count) {
+        const SeqEvent* event = &queue->events[queue->count - 1];
+        if (!s_send_midi_message(forge, uris, frame_offset, 0x80, event->note, 0)) {
+            dropped = queue->count;
+            break;
+        }
+        queue->count--;
+    }
+    return dropped;
+}
+
+void sequencer_begin_block(GridSeqState* state, uint32_t advance, uint32_t n_samples,
+                           bool note_offs, bool by_points, SeqBlock* block) {
+    const uint64_t fps = state->frames_per_step;
+    const uint64_t old_frame = state->frame_counter;
+    const bool was_before_half = old_frame % fps < fps / 2;
+
+    block->start = old_frame;
+    block->end = old_frame + n_samples;
+    block->by_points = by_points || advance >= fps / 2;
+
+    // Long blocks leave the transport to sequencer_next_point()
+    block->until = block->by_points && state->playing ? old_frame + advance : old_frame;
+
+    // Always trigger first step on first run
+    block->play_step = false;
+    block->steps = 0;
+    bool due_note_offs = false;
+    if (state->first_run) {
+        block->play_step = true;
+        state->first_run = false;
+    } else if (!block->by_points) {
+        // A point the last block ended on plays at this block's offset 0
+        if (state->point_due && state->playing) {
+            if (old_frame % fps == 0) {
+                state->current_step = (uint8_t)(old_frame / fps % state->sequence_length);
+                block->play_step = true;
+                block->steps = 1;
+            } else {
+                due_note_offs = true;
+            }
+            state->point_due = false;
+        }
+        // Check if we crossed a step boundary
+        if (sequencer_advance(state, advance)) {
+            block->play_step = true;
+        }
+    }
+
+    // Check if we crossed the 50% point (for Note Off)
+    const uint64_t new_frame = state->frame_counter;
+    const bool is_after_half = new_frame % fps >= fps / 2;
+    block->steps += (uint32_t)(new_frame / fps - old_frame / fps);
+    block->note_offs = ((was_before_half && is_after_half) || due_note_offs) && note_offs;
+    block->half_point = new_frame / fps * fps + fps / 2;
+}
+
+bool sequencer_next_point(GridSeqState* state, SeqBlock* block, SeqPoint* point) {
+    const uint64_t fps = state->frames_per_step;
+    const uint64_t frame = state->frame_counter;
+    const uint64_t step_start = frame / fps * fps;
+
+    // The point the transport stands on if the last block ended on it,
+    // otherwise the next one after it
+    uint64_t next = frame;
+    bool step = frame == step_start;
+    if (!state->point_due) {
+        next = step_start + fps / 2;
+        step = false;
+        if (next <= frame) {
+            next = step_start + fps;
+            step = true;
+        }
+    }
+
+    // A point on the block's end belongs to the next block
+    if (next >= block->until) {
+        state->frame_counter = block->until;
+        state->point_due = next == block->until;
+        return false;
+    }
+
+    state->frame_counter = next;
+    state->point_due = false;
+    if (step) {
+        state->current_step = (uint8_t)(next / fps % state->sequence_length);
+        block->steps++;
+    }
+
+    point->frame = next;
+    point->offset = (uint32_t)(next - block->start);
+    point->step = step;
+    return true;
 }
 
 bool sequencer_advance(GridSeqState* state, uint32_t n_samples) {
@@ -20,6 +20,87 @@ typedef struct {
     LV2_URID midi_MidiEvent;
 } SequencerURIDs;
 
+// Ratchets: a cell can retrigger up to MAX_RATCHET times within its
+// step. Hits are evenly spaced, each with a 50% gate, and ramp up in
+// velocity from SEQ_RATCHET_VELOCITY_START to the normal velocity.
+#define SEQ_NOTE_VELOCITY 100
+#define SEQ_RATCHET_VELOCITY_START 64
+
+// Notes due later than the block they were scheduled in: ratchet hits
+// and the Note Off paired with each. A binary min-heap on frame (Note
+// Offs before Note Ons on the same frame) in a fixed array, so scheduling
+// never allocates and every operation is bounded by SEQ_QUEUE_SIZE.
+// One step of 4-hit ratchets on all 128 notes fits.
+#define SEQ_QUEUE_SIZE (GRID_PITCH_RANGE * MAX_RATCHET * 2)
+
+typedef struct {
+    uint64_t frame;     // On the frame_counter timeline
+    uint8_t note;
+    uint8_t velocity;   // 0 for a Note Off
+} SeqEvent;
+
+typedef struct {
+    SeqEvent events[SEQ_QUEUE_SIZE];
+    uint32_t count;
+} SeqQueue;
+
+// What one block plays, on the frame_counter timeline. The plugin and
+// the offline renderer both take it from sequencer_begin_block(), so a
+// pattern renders exactly as it plays live at the same block size.
+typedef struct {
+    uint64_t start;       // frame_counter at the block's first sample
+    uint64_t end;         // start + n_samples
+    uint64_t half_point;  // Frame of the Note Offs, if note_offs is set
+    uint64_t until;       // Where the transport stops, if by_points is set
+    uint32_t steps;       // Step boundaries crossed
+    bool play_step;       // current_step plays at offset 0
+    bool note_offs;       // The block crosses a step's 50% point
+    bool by_points;       // Steps and Note Offs come from sequencer_next_point()
+} SeqBlock;
+
+// A frame inside a block where the sequencer acts
+typedef struct {
+    uint64_t frame;       // On the frame_counter timeline
+    uint32_t offset;      // Frame offset in the block
+    bool step;            // A step starts (otherwise its 50% point, Note Offs)
+} SeqPoint;
+
+/**
+ * Bytes one MIDI event of the given size takes in a sequence
+ * (event header plus body padded to 64 bits).
+ */
+uint32_t sequencer_midi_event_size(uint32_t size);
+
+/**
+ * Number of single-hit notes one step column plays (set, not muted, or
+ * filled). Ratchets go through the queue and are not counted.
+ */
+uint32_t sequencer_step_note_count(const GridSeqState* state, uint8_t step);
+
+/**
+ * Number of notes currently sounding (waiting for their Note Off).
+ */
+uint32_t sequencer_active_note_count(const GridSeqState* state);
+
+/**
+ * Write one MIDI event if it fits into the forge buffer.
+ * Nothing is written otherwise, so the sequence stays well-formed.
+ *
+ * @param forge Atom forge positioned inside a sequence
+ * @param uris URID mappings
+ * @param frame_offset Frame offset for the event
+ * @param msg MIDI message bytes
+ * @param size Message size in bytes
+ * @return true if the event was written
+ */
+bool sequencer_write_midi(
+    LV2_Atom_Forge* forge,
+    const SequencerURIDs* uris,
+    uint32_t frame_offset,
+    const uint8_t* msg,
+    uint32_t size
+);
+
 /**
  * Process one step of the sequencer.
  * Generates MIDI note events for active steps in the current column.
@@ -28,8 +109,9 @@ typedef struct {
  * @param forge LV2 atom forge for writing MIDI events
  * @param uris URID mappings
  * @param frame_offset Frame offset for this event
+ * @return Number of Note Ons that did not fit into the buffer
  */
-void sequencer_process_step(
+uint32_t sequencer_process_step(
     GridSeqState* state,
     LV2_Atom_Forge* forge,
     const SequencerURIDs* uris,
@@ -43,14 +125,95 @@ void sequencer_process_step(
  * @param forge Atom forge for writing MIDI events
  * @param uris URIDs structure
  * @param frame_offset Frame offset for MIDI events
+ * @return Number of Note Offs that did not fit into the buffer
  */
-void sequencer_process_note_offs(
+uint32_t sequencer_process_note_offs(
     GridSeqState* state,
     LV2_Atom_Forge* forge,
     const SequencerURIDs* uris,
     uint32_t frame_offset
 );
 
+/**
+ * Drop everything scheduled (transport restart).
+ */
+void sequencer_queue_clear(SeqQueue* queue);
+
+/**
+ * Schedule the ratchet cells of the current step: every hit and its Note
+ * Off go into the queue. Real-time safe.
+ *
+ * @param step_frame Frame the step starts on
+ * @param note_offs false in Note On only mode (MIDI filter)
+ * @return Number of hits dropped because the queue was full
+ */
+uint32_t sequencer_schedule_ratchets(const GridSeqState* state, SeqQueue* queue,
+                                     uint64_t step_frame, bool note_offs);
+
+/**
+ * Number of queued events due before a frame (to reserve output space).
+ */
+uint32_t sequencer_queue_due(const SeqQueue* queue, uint64_t until);
+
+/**
+ * Write the queued events due before `until`, in frame order, at their
+ * offset from block_start (late events at offset 0). A Note Off that
+ * does not fit stays queued for the next block; a Note On that does not
+ * fit is dropped.
+ *
+ * @return Number of events that did not fit into the buffer
+ */
+uint32_t sequencer_process_queue(SeqQueue* queue, LV2_Atom_Forge* forge,
+                                 const SequencerURIDs* uris,
+                                 uint64_t block_start, uint64_t until);
+
+/**
+ * Transport restarted from frame 0: queued Note Ons are dropped and the
+ * Note Offs become due at once.
+ */
+void sequencer_queue_restart(SeqQueue* queue);
+
+/**
+ * Transport stopped: send every queued Note Off now and drop the queued
+ * Note Ons, so no ratchet note is left hanging.
+ *
+ * @return Number of Note Offs that did not fit (they stay queued)
+ */
+uint32_t sequencer_queue_release(SeqQueue* queue, LV2_Atom_Forge* forge,
+                                 const SequencerURIDs* uris, uint32_t frame_offset);
+
+/**
+ * Advance the transport for one block and work out what it plays: the
+ * first block after activation plays the current step, later blocks the
+ * step whose boundary they cross, and Note Offs fall on the 50% point.
+ *
+ * A block of half a step or more can hold several boundaries and 50%
+ * points, so it is played point by point instead: the transport stays
+ * where it is and sequencer_next_point() moves it on to each of them.
+ *
+ * @param advance Frames the transport moves on, n_samples unless it
+ *        follows an external clock
+ * @param n_samples Block length
+ * @param note_offs false in Note On only mode (MIDI filter)
+ * @param by_points Play point by point whatever the block length
+ *        (freewheeling)
+ */
+void sequencer_begin_block(GridSeqState* state, uint32_t advance, uint32_t n_samples,
+                           bool note_offs, bool by_points, SeqBlock* block);
+
+/**
+ * Move the transport of a by_points block on to its next step boundary or
+ * 50% point, in frame order. A boundary makes its step current and is
+ * counted in block->steps. Each point sits at its exact offset. When
+ * none is left, the transport is moved on to block->until; a point
+ * exactly there is left due (state->point_due) and the next block plays
+ * it at offset 0, whether it goes point by point or not.
+ *
+ * @param point Filled in with the point reached
+ * @return false when the block has no point left
+ */
+bool sequencer_next_point(GridSeqState* state, SeqBlock* block, SeqPoint* point);
+
 /**
  * Advance the sequencer by n_samples.
  * Returns true if a step boundary was crossed.
@@ -0,0 +1,331 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "smf.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} SmfReader;
+
+typedef struct {
+    GridSeqState* slots;
+    size_t num_slots;
+    uint32_t division;
+    uint32_t steps_per_beat;
+    uint64_t last_step;      // One past the last step that holds data
+    const SmfImportOptions* options;
+    SmfImportResult* result;
+} SmfImport;
+
+static uint32_t s_read_be(const uint8_t* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static bool s_read_vlq(SmfReader* r, uint32_t* value) {
+    uint32_t v = 0;
+
+    // Variable-length quantities are at most 4 bytes (28 bits)
+    for (int i = 0; i < 4; i++) {
+        if (r->pos >= r->end) return false;
+        uint8_t byte = *r->pos++;
+        v = (v << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Round a tick position to the nearest step
+static uint64_t s_tick_to_step(const SmfImport* imp, uint64_t tick) {
+    return (tick * imp->steps_per_beat + imp->division / 2) / imp->division;
+}
+
+static void s_note_on(SmfImport* imp, uint64_t tick, uint8_t channel, uint8_t note, uint8_t velocity) {
+    imp->result->notes_read++;
+
+    if ((imp->options->channel && channel + 1 != imp->options->channel) ||
+        velocity < imp->options->min_velocity) {
+        imp->result->notes_dropped++;
+        return;
+    }
+
+    uint64_t step = s_tick_to_step(imp, tick);
+    uint64_t slot = step / MAX_SEQUENCE_LENGTH;
+    if (slot >= imp->num_slots) {
+        imp->result->notes_dropped++;
+        return;
+    }
+
+    bool* cell = &imp->slots[slot].grid[step % MAX_SEQUENCE_LENGTH][note];
+    if (*cell) {
+        imp->result->notes_merged++;
+    } else {
+        *cell = true;
+        imp->result->notes_imported++;
+    }
+
+    if (step + 1 > imp->last_step) {
+        imp->last_step = step + 1;
+    }
+}
+
+static bool s_parse_track(SmfImport* imp, SmfReader* r, uint64_t* end_tick) {
+    uint64_t tick = 0;
+    uint8_t running_status = 0;
+
+    while (r->pos < r->end) {
+        uint32_t delta;
+        if (!s_read_vlq(r, &delta)) return false;
+        tick += delta;
+
+        if (r->pos >= r->end) return false;
+        uint8_t status = *r->pos;
+
+        if (status == 0xFF) {
+            // Meta event: FF type len data
+            if (r->end - r->pos < 2) return false;
+            uint8_t type = r->pos[1];
+            r->pos += 2;
+
+            uint32_t len;
+            if (!s_read_vlq(r, &len) || (uint32_t)(r->end - r->pos) < len) return false;
+            r->pos += len;
+
+            if (type == 0x2F) {  // End of Track
+                break;
+            }
+            continue;
+        }
+
+        if (status == 0xF0 || status == 0xF7) {
+            // SysEx or escaped data: F0/F7 len data (cancels running status)
+            r->pos++;
+            uint32_t len;
+            if (!s_read_vlq(r, &len) || (uint32_t)(r->end - r->pos) < len) return false;
+            r->pos += len;
+            running_status = 0;
+            continue;
+        }
+
+        if (status & 0x80) {
+            running_status = status;
+            r->pos++;
+        } else if (!running_status) {
+            return false;  // Data byte without a status
+        }
+
+        uint8_t type = running_status & 0xF0;
+        int data_len = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+        if (r->end - r->pos < data_len) return false;
+
+        if (type == 0x90 && r->pos[1] > 0) {
+            s_note_on(imp, tick, running_status & 0x0F, r->pos[0] & 0x7F, r->pos[1]);
+        }
+
+        r->pos += data_len;
+    }
+
+    *end_tick = tick;
+    return true;
+}
+
+GridSeqError smf_import_buffer(
+    const uint8_t* data,
+    size_t size,
+    GridSeqState* slots,
+    size_t num_slots,
+    const SmfImportOptions* options,
+    SmfImportResult* result
+) {
+    if (!data || !slots || num_slots == 0) return GS_ERROR_NULL_POINTER;
+
+    static const SmfImportOptions default_options = {0, 1};
+    SmfImportResult local_result;
+    if (!options) options = &default_options;
+    if (!result) result = &local_result;
+    memset(result, 0, sizeof(SmfImportResult));
+
+    // Header chunk: "MThd" len(6) format ntrks division
+    if (size < 14 || memcmp(data, "MThd", 4) != 0) return GS_ERROR_INVALID_PARAM;
+    uint32_t header_len = s_read_be(data + 4, 4);
+    if (header_len < 6 || header_len > size - 8) return GS_ERROR_INVALID_PARAM;
+
+    result->format = (uint16_t)s_read_be(data + 8, 2);
+    result->num_tracks = (uint16_t)s_read_be(data + 10, 2);
+    result->division = (uint16_t)s_read_be(data + 12, 2);
+
+    // SMPTE time division has no musical grid to quantize to
+    if (result->division == 0 || (result->division & 0x8000)) return GS_ERROR_INVALID_PARAM;
+
+    SmfImport imp = {
+        .slots = slots,
+        .num_slots = num_slots,
+        .division = result->division,
+        .steps_per_beat = slots[0].steps_per_beat ? slots[0].steps_per_beat : DEFAULT_STEPS_PER_BEAT,
+        .last_step = 0,
+        .options = options,
+        .result = result
+    };
+
+    for (size_t i = 0; i < num_slots; i++) {
+        memset(slots[i].grid, 0, sizeof(slots[i].grid));
+    }
+
+    // Track chunks, each parsed once in file order
+    uint64_t end_tick = 0;
+    const uint8_t* pos = data + 8 + header_len;
+    const uint8_t* end = data + size;
+
+    while (end - pos >= 8) {
+        uint32_t chunk_len = s_read_be(pos + 4, 4);
+        if (chunk_len > (uint32_t)(end - pos) - 8) return GS_ERROR_INVALID_PARAM;
+
+        // Unknown chunk types must be skipped
+        if (memcmp(pos, "MTrk", 4) == 0) {
+            SmfReader reader = {pos + 8, pos + 8 + chunk_len};
+            uint64_t track_end = 0;
+            if (!s_parse_track(&imp, &reader, &track_end)) return GS_ERROR_INVALID_PARAM;
+            if (track_end > end_tick) end_tick = track_end;
+        }
+
+        pos += 8 + chunk_len;
+    }
+
+    // Length is the End of Track position rounded up to whole steps
+    uint64_t total_steps = (end_tick * imp.steps_per_beat + imp.division - 1) / imp.division;
+    if (imp.last_step > total_steps) total_steps = imp.last_step;
+    if (total_steps > (uint64_t)num_slots * MAX_SEQUENCE_LENGTH) {
+        total_steps = (uint64_t)num_slots * MAX_SEQUENCE_LENGTH;
+    }
+
+    result->total_steps = (uint32_t)total_steps;
+    result->slots_used = (uint32_t)((total_steps + MAX_SEQUENCE_LENGTH - 1) / MAX_SEQUENCE_LENGTH);
+
+    for (uint32_t i = 0; i < result->slots_used; i++) {
+        uint64_t remaining = total_steps - (uint64_t)i * MAX_SEQUENCE_LENGTH;
+        uint8_t length = remaining > MAX_SEQUENCE_LENGTH ? MAX_SEQUENCE_LENGTH : (uint8_t)remaining;
+        slots[i].sequence_length = length < MIN_SEQUENCE_LENGTH ? MIN_SEQUENCE_LENGTH : length;
+    }
+
+    return GS_OK;
+}
+
+GridSeqError smf_import_file(
+    const char* path,
+    GridSeqState* slots,
+    size_t num_slots,
+    const SmfImportOptions* options,
+    SmfImportResult* result
+) {
+    if (!path) return GS_ERROR_NULL_POINTER;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return GS_ERROR_INVALID_PARAM;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return GS_ERROR_INVALID_PARAM;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return GS_ERROR_INVALID_PARAM;
+
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+    GridSeqError err = smf_import_buffer((const uint8_t*)map, size, slots, num_slots, options, result);
+
+    munmap(map, size);
+    return err;
+}
+
+static uint8_t* s_write_vlq(uint8_t* p, uint32_t value) {
+    uint8_t bytes[4];
+    int n = 0;
+    do {
+        bytes[n++] = value & 0x7F;
+        value >>= 7;
+    } while (value && n < 4);
+
+    while (n > 1) *p++ = bytes[--n] | 0x80;
+    *p++ = bytes[0];
+    return p;
+}
+
+static void s_write_be(uint8_t* p, uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        p[i] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+GridSeqError smf_write(FILE* file, const SmfEvent* events, size_t count, uint32_t end_tick,
+                       uint16_t division, double bpm) {
+    if (!file || (!events && count) || !division || bpm <= 0.0) return GS_ERROR_INVALID_PARAM;
+
+    // Delta (up to 4 bytes) and message per event, tempo and end of track
+    uint8_t* track = (uint8_t*)malloc(count * 7 + 20);
+    if (!track) return GS_ERROR_OUT_OF_MEMORY;
+
+    uint8_t* p = track;
+    const uint32_t tempo = (uint32_t)(60000000.0 / bpm + 0.5);
+    *p++ = 0x00;
+    *p++ = 0xFF;
+    *p++ = 0x51;
+    *p++ = 0x03;
+    s_write_be(p, tempo, 3);
+    p += 3;
+
+    uint32_t last = 0;
+    for (size_t i = 0; i < count; i++) {
+        const SmfEvent* ev = &events[i];
+        p = s_write_vlq(p, ev->tick > last ? ev->tick - last : 0);
+        if (ev->tick > last) last = ev->tick;
+        memcpy(p, ev->msg, ev->size);
+        p += ev->size;
+    }
+
+    p = s_write_vlq(p, end_tick > last ? end_tick - last : 0);
+    *p++ = 0xFF;
+    *p++ = 0x2F;
+    *p++ = 0x00;
+
+    const uint32_t track_size = (uint32_t)(p - track);
+    uint8_t header[22] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1};
+    s_write_be(header + 12, division, 2);
+    memcpy(header + 14, "MTrk", 4);
+    s_write_be(header + 18, track_size, 4);
+
+    const bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+                    fwrite(track, track_size, 1, file) == 1;
+    free(track);
+    return ok ? GS_OK : GS_ERROR_INVALID_PARAM;
+}
@@ -0,0 +1,109 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_SMF_H
+#define GRID_SEQ_SMF_H
+
+#include "state.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// Standard MIDI File import into grid patterns.
+//
+// Note On events are quantized to the nearest step of the target slot's
+// resolution (steps_per_beat). A grid cell is a single on/off bit played
+// with a fixed velocity and a 50% gate, so velocity is only used to drop
+// notes below min_velocity and note lengths are discarded.
+//
+// Files longer than MAX_SEQUENCE_LENGTH steps are split across consecutive
+// slots (slot 0 holds steps 0-15, slot 1 steps 16-31, ...).
+
+typedef struct {
+    uint8_t channel;        // 0 = all channels, 1-16 = only this channel
+    uint8_t min_velocity;   // Note Ons below this velocity are ignored
+} SmfImportOptions;
+
+typedef struct {
+    uint16_t format;          // SMF format (0, 1 or 2)
+    uint16_t num_tracks;      // Tracks declared in the header
+    uint16_t division;        // Ticks per quarter note
+    uint32_t total_steps;     // File length in steps at the slot resolution
+    uint32_t slots_used;      // Number of slots written
+    uint32_t notes_read;      // Note On events seen
+    uint32_t notes_imported;  // Notes that set a grid cell
+    uint32_t notes_merged;    // Notes quantized onto an already set cell
+    uint32_t notes_dropped;   // Notes beyond the last slot or filtered out
+} SmfImportResult;
+
+/**
+ * Import a Standard MIDI File from memory.
+ *
+ * Each slot must be initialized with state_init() beforehand; its
+ * steps_per_beat selects the quantization grid and its grid is cleared
+ * before importing. Tracks are parsed in a single pass.
+ *
+ * @param data File contents
+ * @param size Size of data in bytes
+ * @param slots Pattern slots to fill
+ * @param num_slots Number of slots available
+ * @param options Import options (NULL for defaults)
+ * @param result Import statistics (may be NULL)
+ * @return GS_OK on success, GS_ERROR_INVALID_PARAM on malformed or
+ *         SMPTE-timed files
+ */
+GridSeqError smf_import_buffer(
+    const uint8_t* data,
+    size_t size,
+    GridSeqState* slots,
+    size_t num_slots,
+    const SmfImportOptions* options,
+    SmfImportResult* result
+);
+
+/**
+ * Import a Standard MIDI File from disk.
+ *
+ * The file is memory-mapped read-only and parsed with smf_import_buffer().
+ *
+ * @return GS_OK on success, GS_ERROR_INVALID_PARAM if the file cannot be
+ *         opened or parsed
+ */
+GridSeqError smf_import_file(
+    const char* path,
+    GridSeqState* slots,
+    size_t num_slots,
+    const SmfImportOptions* options,
+    SmfImportResult* result
+);
+
+// Standard MIDI File export: one format 0 track with a tempo event
+typedef struct {
+    uint32_t tick;    // Absolute time in ticks
+    uint8_t size;     // Message size, 1 to 3 bytes
+    uint8_t msg[3];
+} SmfEvent;
+
+/**
+ * Write events (in time order) as a format 0 Standard MIDI File.
+ *
+ * @param end_tick Length of the track: End of Track goes there, or on
+ *        the last event if that is later, so a loop ending in rests
+ *        keeps its length
+ * @param division Ticks per quarter note
+ * @param bpm Tempo written to the file
+ * @return GS_OK on success, GS_ERROR_INVALID_PARAM on a write error,
+ *         GS_ERROR_OUT_OF_MEMORY if the track cannot be built
+ */
+GridSeqError smf_write(FILE* file, const SmfEvent* events, size_t count, uint32_t end_tick,
+                       uint16_t division, double bpm);
+
+#endif // GRID_SEQ_SMF_H
@@ -24,8 +24,11 @@ void state_init(GridSeqState* state, double sample_rate) {
     state->previous_step = 0;
     state->sequence_length = DEFAULT_SEQUENCE_LENGTH;
     state->hardware_page = 0;
+    state->steps_per_beat = DEFAULT_STEPS_PER_BEAT;
     state->playing = false;
     state->frame_counter = 0;
+    state->point_due = false;
+    state_set_scale(state, SCALE_CHROMATIC, 0);
 
     // Default to 120 BPM, 8 steps per 2 bars
     // 2 bars at 4/4 = 8 beats, 8 steps = 1 beat per step
@@ -41,8 +44,161 @@ void state_toggle_step(GridSeqState* state, uint8_t x, uint8_t y) {
 void state_update_tempo(GridSeqState* state, double bpm) {
     if (!state || bpm <= 0.0) return;
 
-    // 1 beat per step, calculate frames per step
+    state->bpm = bpm;
+
+    // steps_per_beat steps per beat, calculate frames per step
     double beats_per_second = bpm / 60.0;
     double seconds_per_beat = 1.0 / beats_per_second;
-    state->frames_per_step = (uint64_t)(seconds_per_beat * state->sample_rate);
+    uint8_t steps_per_beat = state->steps_per_beat ? state->steps_per_beat : DEFAULT_STEPS_PER_BEAT;
+    state->frames_per_step = (uint64_t)(seconds_per_beat * state->sample_rate / steps_per_beat);
+}
+
+bool state_set_row_length(GridSeqState* state, uint8_t note, uint8_t length) {
+    if (!state || note >= GRID_PITCH_RANGE || length > MAX_SEQUENCE_LENGTH) return false;
+
+    state->row_length[note] = length;
+    return true;
+}
+
+uint8_t state_row_length(const GridSeqState* state, uint8_t note) {
+    const uint8_t length = state->row_length[note];
+    return length && length < state->sequence_length ? length : state->sequence_length;
+}
+
+uint8_t state_row_step(const GridSeqState* state, uint8_t note) {
+    const uint8_t length = state->row_length[note];
+    if (!length || length >= state->sequence_length) return state->current_step;
+
+    return (uint8_t)((state->frame_counter / state->frames_per_step) % length);
+}
+
+bool state_set_scale(GridSeqState* state, uint8_t scale, uint8_t key) {
+    if (!state || scale >= SCALE_COUNT || key >= 12) return false;
+
+    state->scale = scale;
+    state->key = key;
+    scale_build(state->row_note, scale, key);
+    return true;
+}
+
+bool state_set_ratchet(GridSeqState* state, uint8_t step, uint8_t note, uint8_t hits) {
+    if (!state || step >= MAX_GRID_SIZE || note >= GRID_PITCH_RANGE || hits > MAX_RATCHET) {
+        return false;
+    }
+
+    state->ratchet[step][note] = hits > 1 ? hits : 0;
+    return true;
+}
+
+uint8_t state_ratchet(const GridSeqState* state, uint8_t step, uint8_t note) {
+    const uint8_t hits = state->ratchet[step][note];
+    return hits > 1 ? hits : 1;
+}
+
+void state_pack_snapshot(const GridSeqState* state, GridSnapshot* snapshot) {
+    if (!state || !snapshot) return;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->sequence_length = state->sequence_length;
+    snapshot->pitch_offset = state->pitch_offset;
+    snapshot->current_step = state->current_step;
+    snapshot->scale = state->scale;
+    snapshot->key = state->key;
+
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            if (state->grid[x][note]) {
+                snapshot->cells[x][note / 8] |= (uint8_t)(1u << (note % 8));
+            }
+        }
+    }
+    memcpy(snapshot->row_lengths, state->row_length, sizeof(snapshot->row_lengths));
+
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            const uint8_t bits = (uint8_t)(state_ratchet(state, x, note) - 1);
+            snapshot->ratchets[x][note / 4] |= (uint8_t)(bits << (2 * (note % 4)));
+        }
+    }
+}
+
+void state_unpack_snapshot(GridSeqState* state, const GridSnapshot* snapshot) {
+    if (!state || !snapshot) return;
+
+    if (snapshot->sequence_length >= MIN_SEQUENCE_LENGTH &&
+        snapshot->sequence_length <= MAX_SEQUENCE_LENGTH) {
+        state->sequence_length = snapshot->sequence_length;
+    }
+    state->pitch_offset = snapshot->pitch_offset;
+    if (snapshot->current_step < MAX_GRID_SIZE) {
+        state->current_step = snapshot->current_step;
+    }
+    if (snapshot->scale != state->scale || snapshot->key != state->key) {
+        state_set_scale(state, snapshot->scale, snapshot->key);
+    }
+
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            state->grid[x][note] = (snapshot->cells[x][note / 8] >> (note % 8)) & 1;
+        }
+    }
+    for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+        state_set_row_length(state, note, snapshot->row_lengths[note]);
+    }
+
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t note = 0; note < GRID_PITCH_RANGE; note++) {
+            const uint8_t bits = (snapshot->ratchets[x][note / 4] >> (2 * (note % 4))) & 3;
+            state_set_ratchet(state, x, note, (uint8_t)(bits + 1));
+        }
+    }
+}
+
+void state_edit_clear(GridEdit* edit) {
+    if (edit) memset(edit, 0, sizeof(*edit));
+}
+
+void state_edit_set(GridEdit* edit, uint8_t step, uint8_t note, bool value) {
+    if (!edit || step >= MAX_GRID_SIZE || note >= GRID_PITCH_RANGE) return;
+
+    const uint8_t bit = (uint8_t)(1u << (note % 8));
+    edit->mask[step][note / 8] |= bit;
+    if (value) {
+        edit->cells[step][note / 8] |= bit;
+    } else {
+        edit->cells[step][note / 8] &= (uint8_t)~bit;
+    }
+}
+
+bool state_edit_get(const GridEdit* edit, uint8_t step, uint8_t note, bool* value) {
+    if (!edit || step >= MAX_GRID_SIZE || note >= GRID_PITCH_RANGE) return false;
+
+    const uint8_t bit = (uint8_t)(1u << (note % 8));
+    if (!(edit->mask[step][note / 8] & bit)) return false;
+    if (value) *value = (edit->cells[step][note / 8] & bit) != 0;
+    return true;
+}
+
+uint32_t state_apply_edit(GridSeqState* state, const GridEdit* edit) {
+    if (!state || !edit) return 0;
+
+    uint32_t changed = 0;
+    for (uint8_t x = 0; x < MAX_GRID_SIZE; x++) {
+        for (uint8_t byte = 0; byte < GRID_SNAPSHOT_COLUMN_BYTES; byte++) {
+            const uint8_t mask = edit->mask[x][byte];
+            if (!mask) continue;
+
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                if (!(mask & (1u << bit))) continue;
+
+                const uint8_t note = (uint8_t)(byte * 8 + bit);
+                const bool value = (edit->cells[x][byte] >> bit) & 1;
+                if (state->grid[x][note] != value) {
+                    state->grid[x][note] = value;
+                    changed++;
+                }
+            }
+        }
+    }
+    return changed;
 }
@@ -14,6 +14,7 @@
 #define GRID_SEQ_STATE_H
 
 #include "grid_seq/common.h"
+#include "scale.h"
 
 typedef struct {
     bool grid[MAX_GRID_SIZE][GRID_PITCH_RANGE];  // Full MIDI range 0-127
@@ -22,13 +23,25 @@ typedef struct {
     uint8_t previous_step;
     uint8_t sequence_length;    // 2-16 steps
     uint8_t hardware_page;      // 0 or 1 for Launchpad paging
+    uint8_t steps_per_beat;     // Grid resolution (1-8 steps per beat)
     double beats_per_bar;
+    double bpm;                 // Tempo that frames_per_step was derived from
     double sample_rate;
     bool playing;
     bool first_run;
+    bool point_due;             // A step or 50% point at frame_counter is still to play
     uint64_t frame_counter;
     uint64_t frames_per_step;
     bool active_notes[128];  // Track which notes are currently on
+    bool muted[GRID_PITCH_RANGE];  // Rows that do not play
+    bool fill;                  // Fill held: every used row plays each step
+    bool shift;                 // Shift held: second control layer, plays nothing
+    uint8_t row_length[GRID_PITCH_RANGE];  // Own loop length, 0 follows sequence_length
+    uint8_t ratchet[MAX_GRID_SIZE][GRID_PITCH_RANGE];  // Hits per cell, 0 or 1 for one
+    uint8_t scale;              // ScaleType the rows follow
+    uint8_t key;                // Root pitch class, 0 (C) to 11 (B)
+    uint8_t row_note[GRID_PITCH_RANGE];  // MIDI note per row, built by state_set_scale()
+    int8_t row_offset[GRID_PITCH_RANGE];  // Keyboard follow, added as rows play
 } GridSeqState;
 
 /**
@@ -56,4 +69,100 @@ void state_toggle_step(GridSeqState* state, uint8_t x, uint8_t y);
  */
 void state_update_tempo(GridSeqState* state, double bpm);
 
+/**
+ * Set a row's loop length. Rows loop over their first `length` steps,
+ * counted from transport start, while the sequence plays on.
+ *
+ * @param note Row (MIDI note)
+ * @param length 1 to MAX_SEQUENCE_LENGTH, or 0 to follow sequence_length
+ * @return false if the note or length is out of range
+ */
+bool state_set_row_length(GridSeqState* state, uint8_t note, uint8_t length);
+
+/**
+ * Loop length a row plays with: its own, capped at sequence_length.
+ */
+uint8_t state_row_length(const GridSeqState* state, uint8_t note);
+
+/**
+ * Step a row is on. Rows without their own length are on current_step;
+ * the others count steps since transport start modulo their length.
+ */
+uint8_t state_row_step(const GridSeqState* state, uint8_t note);
+
+/**
+ * Choose the scale and key rows map to and rebuild row_note. Rows keep
+ * their cells, so a pattern keeps its shape in the new scale.
+ *
+ * @param scale ScaleType
+ * @param key Root pitch class, 0 (C) to 11 (B)
+ * @return false if either is out of range
+ */
+bool state_set_scale(GridSeqState* state, uint8_t scale, uint8_t key);
+
+/**
+ * MIDI note a row plays, SCALE_NO_NOTE if the scale puts it outside 0-127.
+ */
+static inline uint8_t state_row_note(const GridSeqState* state, uint8_t row) {
+    return state->row_note[row];
+}
+
+/**
+ * MIDI note a row is sent as: its scale note moved by the keyboard follow
+ * offset. SCALE_NO_NOTE when that leaves 0-127.
+ */
+static inline uint8_t state_output_note(const GridSeqState* state, uint8_t row) {
+    const int note = state->row_note[row] + state->row_offset[row];
+    return state->row_note[row] != SCALE_NO_NOTE && note >= 0 && note < GRID_PITCH_RANGE
+               ? (uint8_t)note : SCALE_NO_NOTE;
+}
+
+/**
+ * Set how many times a cell retriggers within its step.
+ *
+ * @param hits 1 to MAX_RATCHET (0 is taken as 1)
+ * @return false if the cell or count is out of range
+ */
+bool state_set_ratchet(GridSeqState* state, uint8_t step, uint8_t note, uint8_t hits);
+
+/**
+ * Hits a cell plays, 1 unless it ratchets.
+ */
+uint8_t state_ratchet(const GridSeqState* state, uint8_t step, uint8_t note);
+
+/**
+ * Pack the grid and view into a snapshot for the UI.
+ */
+void state_pack_snapshot(const GridSeqState* state, GridSnapshot* snapshot);
+
+/**
+ * Load the grid and view from a snapshot (UI side).
+ */
+void state_unpack_snapshot(GridSeqState* state, const GridSnapshot* snapshot);
+
+/**
+ * Start an empty edit transaction.
+ */
+void state_edit_clear(GridEdit* edit);
+
+/**
+ * Add a cell to an edit. Setting a cell twice keeps the last value.
+ */
+void state_edit_set(GridEdit* edit, uint8_t step, uint8_t note, bool value);
+
+/**
+ * Look up a cell in an edit (UI preview of an edit not yet applied).
+ *
+ * @param value Set to the cell's new value when the edit touches it
+ * @return true if the edit touches the cell
+ */
+bool state_edit_get(const GridEdit* edit, uint8_t step, uint8_t note, bool* value);
+
+/**
+ * Apply an edit to the grid. Real-time safe.
+ *
+ * @return Number of cells that changed
+ */
+uint32_t state_apply_edit(GridSeqState* state, const GridEdit* edit);
+
 #endif // GRID_SEQ_STATE_H
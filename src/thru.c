@@ -0,0 +1,28 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#include "thru.h"
+
+bool thru_accept(const ThruFilter* filter, const uint8_t* msg, uint32_t size) {
+    if (!filter || !msg || size == 0 || filter->mode == THRU_OFF) return false;
+
+    const uint8_t status = msg[0];
+    if (status < 0x80) return false;  // Running status is not used in atoms
+    if (status >= 0xF0) return filter->mode == THRU_ALL;
+
+    if (filter->channel && (status & 0x0F) != filter->channel - 1) return false;
+
+    const uint8_t type = status & 0xF0;
+    const bool note = type == 0x80 || type == 0x90 || type == 0xA0;
+    return note || filter->mode >= THRU_CHANNEL;
+}
@@ -0,0 +1,46 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+
+#ifndef GRID_SEQ_THRU_H
+#define GRID_SEQ_THRU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// MIDI thru: messages on midi_in that the plugin does not use itself
+// (Launchpad pads and buttons, keyboard follow keys) can be passed on to
+// midi_out, merged with the generated notes in frame order.
+
+#define THRU_MAX_EVENTS 256  // Input events passed on per block
+
+typedef enum {
+    THRU_OFF = 0,
+    THRU_NOTES = 1,      // Note On/Off and polyphonic aftertouch
+    THRU_CHANNEL = 2,    // Notes plus controllers, programs, pressure and bend
+    THRU_ALL = 3         // Every message, SysEx and realtime included
+} ThruMode;
+
+typedef struct {
+    uint8_t mode;     // ThruMode
+    uint8_t channel;  // 1-16, or 0 for every channel (system messages ignore it)
+} ThruFilter;
+
+/**
+ * Whether a message passes the filter.
+ *
+ * @param msg MIDI message, status byte first
+ * @param size Message size in bytes
+ */
+bool thru_accept(const ThruFilter* filter, const uint8_t* msg, uint32_t size);
+
+#endif // GRID_SEQ_THRU_H
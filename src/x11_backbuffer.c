@@ -0,0 +1,254 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#include "x11_backbuffer.h"
+
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BACKBUFFER_MAX_RECTS 8
+
+typedef struct {
+    int x, y, width, height;
+} DamageRect;
+
+struct X11Backbuffer {
+    Display* display;
+    Window window;
+    GC gc;
+    XImage* image;
+    cairo_surface_t* surface;
+    int width;
+    int height;
+
+    bool use_shm;
+    XShmSegmentInfo shm;
+    int completion_event;   // ShmCompletion event type
+    bool busy;              // Server still reading the last frame
+
+    DamageRect damage[BACKBUFFER_MAX_RECTS];
+    int num_damage;
+};
+
+static bool s_attach_failed;
+
+static int s_attach_error_handler(Display* display, XErrorEvent* event) {
+    (void)display;
+    (void)event;
+    s_attach_failed = true;
+    return 0;
+}
+
+// Try to put the image into shared memory. Fails on remote displays,
+// where XShmAttach is refused.
+static bool s_create_shm_image(X11Backbuffer* buffer, Visual* visual, int depth) {
+    if (!XShmQueryExtension(buffer->display)) return false;
+
+    buffer->image = XShmCreateImage(buffer->display, visual, (unsigned)depth, ZPixmap, NULL,
+                                    &buffer->shm, (unsigned)buffer->width, (unsigned)buffer->height);
+    if (!buffer->image) return false;
+
+    buffer->shm.shmid = shmget(IPC_PRIVATE,
+                               (size_t)buffer->image->bytes_per_line * buffer->image->height,
+                               IPC_CREAT | 0600);
+    if (buffer->shm.shmid < 0) goto fail_image;
+
+    buffer->shm.shmaddr = buffer->image->data = (char*)shmat(buffer->shm.shmid, NULL, 0);
+    if (buffer->shm.shmaddr == (char*)-1) goto fail_segment;
+    buffer->shm.readOnly = False;
+
+    // Attach errors arrive asynchronously: sync once, at creation only
+    s_attach_failed = false;
+    XErrorHandler previous = XSetErrorHandler(s_attach_error_handler);
+    Status attached = XShmAttach(buffer->display, &buffer->shm);
+    XSync(buffer->display, False);
+    XSetErrorHandler(previous);
+
+    // Removed now, freed once both sides have detached
+    shmctl(buffer->shm.shmid, IPC_RMID, NULL);
+
+    if (!attached || s_attach_failed) {
+        shmdt(buffer->shm.shmaddr);
+        goto fail_image;
+    }
+
+    buffer->completion_event = XShmGetEventBase(buffer->display) + ShmCompletion;
+    return true;
+
+fail_segment:
+    shmctl(buffer->shm.shmid, IPC_RMID, NULL);
+fail_image:
+    buffer->image->data = NULL;
+    XDestroyImage(buffer->image);
+    buffer->image = NULL;
+    return false;
+}
+
+static bool s_create_plain_image(X11Backbuffer* buffer, Visual* visual, int depth) {
+    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, buffer->width);
+    char* data = (char*)calloc((size_t)stride, (size_t)buffer->height);
+    if (!data) return false;
+
+    buffer->image = XCreateImage(buffer->display, visual, (unsigned)depth, ZPixmap, 0, data,
+                                 (unsigned)buffer->width, (unsigned)buffer->height, 32, stride);
+    if (!buffer->image) {
+        free(data);
+        return false;
+    }
+    return true;
+}
+
+X11Backbuffer* backbuffer_create(Display* display, Window window, Visual* visual,
+                                 int depth, int width, int height) {
+    if (!display || !visual || width <= 0 || height <= 0) return NULL;
+
+    // Cairo's RGB24 layout matches 24-bit TrueColor with 8-bit channels
+    if ((depth != 24 && depth != 32) || visual->red_mask != 0xFF0000 ||
+        visual->green_mask != 0x00FF00 || visual->blue_mask != 0x0000FF) {
+        return NULL;
+    }
+
+    X11Backbuffer* buffer = (X11Backbuffer*)calloc(1, sizeof(X11Backbuffer));
+    if (!buffer) return NULL;
+
+    buffer->display = display;
+    buffer->window = window;
+    buffer->width = width;
+    buffer->height = height;
+
+    buffer->use_shm = s_create_shm_image(buffer, visual, depth);
+    if (!buffer->use_shm && !s_create_plain_image(buffer, visual, depth)) {
+        free(buffer);
+        return NULL;
+    }
+
+    if (buffer->image->bits_per_pixel != 32) {
+        backbuffer_destroy(buffer);
+        return NULL;
+    }
+
+    buffer->surface = cairo_image_surface_create_for_data(
+        (unsigned char*)buffer->image->data, CAIRO_FORMAT_RGB24,
+        width, height, buffer->image->bytes_per_line);
+    buffer->gc = XCreateGC(display, window, 0, NULL);
+
+    return buffer;
+}
+
+void backbuffer_destroy(X11Backbuffer* buffer) {
+    if (!buffer) return;
+
+    if (buffer->surface) {
+        cairo_surface_destroy(buffer->surface);
+    }
+    if (buffer->gc) {
+        XFreeGC(buffer->display, buffer->gc);
+    }
+
+    if (buffer->use_shm) {
+        XShmDetach(buffer->display, &buffer->shm);
+        XSync(buffer->display, False);
+        shmdt(buffer->shm.shmaddr);
+        buffer->image->data = NULL;
+    }
+    if (buffer->image) {
+        XDestroyImage(buffer->image);  // Frees plain image data too
+    }
+
+    free(buffer);
+}
+
+cairo_surface_t* backbuffer_surface(X11Backbuffer* buffer) {
+    return buffer ? buffer->surface : NULL;
+}
+
+bool backbuffer_uses_shm(const X11Backbuffer* buffer) {
+    return buffer && buffer->use_shm;
+}
+
+static bool s_overlaps(const DamageRect* a, const DamageRect* b) {
+    return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+           a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static void s_merge(DamageRect* into, const DamageRect* rect) {
+    int x1 = into->x + into->width > rect->x + rect->width ? into->x + into->width : rect->x + rect->width;
+    int y1 = into->y + into->height > rect->y + rect->height ? into->y + into->height : rect->y + rect->height;
+    into->x = into->x < rect->x ? into->x : rect->x;
+    into->y = into->y < rect->y ? into->y : rect->y;
+    into->width = x1 - into->x;
+    into->height = y1 - into->y;
+}
+
+void backbuffer_damage(X11Backbuffer* buffer, int x, int y, int width, int height) {
+    if (!buffer) return;
+
+    // Clip to the buffer
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > buffer->width) width = buffer->width - x;
+    if (y + height > buffer->height) height = buffer->height - y;
+    if (width <= 0 || height <= 0) return;
+
+    DamageRect rect = {x, y, width, height};
+    for (int i = 0; i < buffer->num_damage; i++) {
+        if (s_overlaps(&buffer->damage[i], &rect)) {
+            s_merge(&buffer->damage[i], &rect);
+            return;
+        }
+    }
+
+    if (buffer->num_damage == BACKBUFFER_MAX_RECTS) {
+        s_merge(&buffer->damage[0], &rect);
+        return;
+    }
+    buffer->damage[buffer->num_damage++] = rect;
+}
+
+bool backbuffer_ready(const X11Backbuffer* buffer) {
+    return buffer && !buffer->busy;
+}
+
+void backbuffer_present(X11Backbuffer* buffer) {
+    if (!buffer || buffer->busy || buffer->num_damage == 0) return;
+
+    cairo_surface_flush(buffer->surface);
+
+    for (int i = 0; i < buffer->num_damage; i++) {
+        const DamageRect* r = &buffer->damage[i];
+        if (buffer->use_shm) {
+            // Completion is only requested for the last rectangle
+            bool last = i == buffer->num_damage - 1;
+            XShmPutImage(buffer->display, buffer->window, buffer->gc, buffer->image,
+                         r->x, r->y, r->x, r->y, (unsigned)r->width, (unsigned)r->height,
+                         last ? True : False);
+        } else {
+            XPutImage(buffer->display, buffer->window, buffer->gc, buffer->image,
+                      r->x, r->y, r->x, r->y, (unsigned)r->width, (unsigned)r->height);
+        }
+    }
+
+    buffer->busy = buffer->use_shm;
+    buffer->num_damage = 0;
+    XFlush(buffer->display);
+}
+
+bool backbuffer_handle_event(X11Backbuffer* buffer, const XEvent* event) {
+    if (!buffer || !buffer->use_shm || event->type != buffer->completion_event) return false;
+
+    buffer->busy = false;
+    return true;
+}
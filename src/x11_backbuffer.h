@@ -0,0 +1,80 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_X11_BACKBUFFER_H
+#define GRID_SEQ_X11_BACKBUFFER_H
+
+#include <X11/Xlib.h>
+#include <cairo/cairo.h>
+#include <stdbool.h>
+
+// Client-side back buffer for the X11 UI.
+//
+// The UI draws into a Cairo image surface in its own memory, so drawing
+// generates no X protocol traffic. backbuffer_present() then copies only
+// the damaged rectangles to the window: with MIT-SHM the server reads the
+// pixels straight from shared memory (XShmPutImage), otherwise they are
+// sent with XPutImage. SHM is unavailable on remote displays, and is
+// detected at creation.
+//
+// An SHM transfer completes asynchronously; the buffer must not be drawn
+// into until the server reports completion, so the canvas passes the
+// window's events to backbuffer_handle_event() and checks
+// backbuffer_ready() before drawing. No round trip to the server is ever waited for.
+
+typedef struct X11Backbuffer X11Backbuffer;
+
+/**
+ * Create a back buffer for a window.
+ *
+ * @return Back buffer, or NULL if the visual is not 24-bit TrueColor
+ *         (draw to a cairo_xlib_surface instead)
+ */
+X11Backbuffer* backbuffer_create(Display* display, Window window, Visual* visual,
+                                 int depth, int width, int height);
+
+void backbuffer_destroy(X11Backbuffer* buffer);
+
+/**
+ * Surface to draw into. Owned by the back buffer.
+ */
+cairo_surface_t* backbuffer_surface(X11Backbuffer* buffer);
+
+/**
+ * Whether pixels go through MIT-SHM (false: XPutImage fallback).
+ */
+bool backbuffer_uses_shm(const X11Backbuffer* buffer);
+
+/**
+ * Mark a rectangle as changed. Overlapping or excess rectangles are
+ * merged, so damage is always a few rectangles at most.
+ */
+void backbuffer_damage(X11Backbuffer* buffer, int x, int y, int width, int height);
+
+/**
+ * False while the server is still reading the previous frame.
+ */
+bool backbuffer_ready(const X11Backbuffer* buffer);
+
+/**
+ * Copy the damaged rectangles to the window and clear the damage.
+ */
+void backbuffer_present(X11Backbuffer* buffer);
+
+/**
+ * Let the back buffer see an X event (SHM completion).
+ *
+ * @return true if the event was consumed
+ */
+bool backbuffer_handle_event(X11Backbuffer* buffer, const XEvent* event);
+
+#endif // GRID_SEQ_X11_BACKBUFFER_H
@@ -0,0 +1,495 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2_host.h"
+
+#include <lv2/atom/util.h>
+#include <lv2/midi/midi.h>
+#include <lv2/time/time.h>
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_LINE_SIZE (HOST_EVENT_MAX_SIZE * 3 + 128)
+
+static LV2_URID s_map_uri(LV2_URID_Map_Handle handle, const char* uri) {
+    LV2Host* host = (LV2Host*)handle;
+
+    for (uint32_t i = 0; i < host->num_uris; i++) {
+        if (strcmp(host->uris[i], uri) == 0) {
+            return i + 1;
+        }
+    }
+
+    if (host->num_uris >= HOST_MAX_URIDS) {
+        return 0;
+    }
+
+    size_t len = strlen(uri) + 1;
+    host->uris[host->num_uris] = (char*)malloc(len);
+    memcpy(host->uris[host->num_uris], uri, len);
+    return ++host->num_uris;
+}
+
+// Work queue entries are a uint32_t size followed by the padded message
+static bool s_queue_push(uint8_t* queue, uint32_t* queue_size, uint32_t size, const void* data) {
+    uint32_t padded = (size + 3u) & ~3u;
+    if (*queue_size + sizeof(uint32_t) + padded > HOST_WORK_QUEUE_SIZE) {
+        return false;
+    }
+
+    memcpy(queue + *queue_size, &size, sizeof(uint32_t));
+    memcpy(queue + *queue_size + sizeof(uint32_t), data, size);
+    *queue_size += (uint32_t)sizeof(uint32_t) + padded;
+    return true;
+}
+
+// Called from run(): must stay real-time safe
+static LV2_Worker_Status s_schedule_work(LV2_Worker_Schedule_Handle handle, uint32_t size, const void* data) {
+    LV2Host* host = (LV2Host*)handle;
+    return s_queue_push(host->work_queue, &host->work_queue_size, size, data)
+        ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+}
+
+static LV2_Worker_Status s_respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data) {
+    LV2Host* host = (LV2Host*)handle;
+    return s_queue_push(host->response_queue, &host->response_queue_size, size, data)
+        ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+}
+
+static void s_run_worker(LV2Host* host) {
+    if (!host->worker) {
+        host->work_queue_size = 0;
+        return;
+    }
+
+    for (uint32_t pos = 0; pos < host->work_queue_size;) {
+        uint32_t size;
+        memcpy(&size, host->work_queue + pos, sizeof(uint32_t));
+        host->worker->work(host->instance, s_respond, host, size, host->work_queue + pos + sizeof(uint32_t));
+        pos += (uint32_t)sizeof(uint32_t) + ((size + 3u) & ~3u);
+    }
+    host->work_queue_size = 0;
+
+    for (uint32_t pos = 0; pos < host->response_queue_size;) {
+        uint32_t size;
+        memcpy(&size, host->response_queue + pos, sizeof(uint32_t));
+        if (host->worker->work_response) {
+            host->worker->work_response(host->instance, size, host->response_queue + pos + sizeof(uint32_t));
+        }
+        pos += (uint32_t)sizeof(uint32_t) + ((size + 3u) & ~3u);
+    }
+    host->response_queue_size = 0;
+
+    if (host->worker->end_run) {
+        host->worker->end_run(host->instance);
+    }
+}
+
+// Look up the rtcheck entry points if the shim is preloaded
+static void s_find_rtcheck(LV2Host* host) {
+    void* self = dlopen(NULL, RTLD_NOW);
+    if (!self) return;
+
+    *(void**)(&host->rt_enter) = dlsym(self, "rtcheck_enter");
+    *(void**)(&host->rt_leave) = dlsym(self, "rtcheck_leave");
+    *(void**)(&host->rt_violations) = dlsym(self, "rtcheck_violations");
+    if (!host->rt_enter || !host->rt_leave || !host->rt_violations) {
+        host->rt_enter = NULL;
+        host->rt_leave = NULL;
+        host->rt_violations = NULL;
+    }
+
+    dlclose(self);
+}
+
+const LV2_Descriptor* host_load(LV2Host* host, const char* path) {
+    host->library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!host->library) {
+        fprintf(stderr, "host: %s\n", dlerror());
+        return NULL;
+    }
+
+    LV2_Descriptor_Function descriptor_function;
+    *(void**)(&descriptor_function) = dlsym(host->library, "lv2_descriptor");
+    if (!descriptor_function) {
+        fprintf(stderr, "host: %s has no lv2_descriptor\n", path);
+        return NULL;
+    }
+
+    return descriptor_function(0);
+}
+
+void host_init(LV2Host* host, const LV2_Descriptor* descriptor, double sample_rate) {
+    void* library = host->library;
+
+    memset(host, 0, sizeof(LV2Host));
+    host->library = library;
+    host->descriptor = descriptor;
+    host->sample_rate = sample_rate;
+
+    host->map.handle = host;
+    host->map.map = s_map_uri;
+    host->map_feature.URI = LV2_URID__map;
+    host->map_feature.data = &host->map;
+    host_add_feature(host, &host->map_feature);
+
+    host->schedule.handle = host;
+    host->schedule.schedule_work = s_schedule_work;
+    host->schedule_feature.URI = LV2_WORKER__schedule;
+    host->schedule_feature.data = &host->schedule;
+    host_add_feature(host, &host->schedule_feature);
+
+    lv2_atom_forge_init(&host->forge, &host->map);
+    s_find_rtcheck(host);
+}
+
+unsigned host_rt_violations(const LV2Host* host) {
+    return host->rt_violations ? host->rt_violations() : 0;
+}
+
+bool host_rt_checking(const LV2Host* host) {
+    return host->rt_enter != NULL;
+}
+
+void host_add_feature(LV2Host* host, const LV2_Feature* feature) {
+    if (host->num_features < HOST_MAX_FEATURES) {
+        host->features[host->num_features++] = feature;
+        host->features[host->num_features] = NULL;
+    }
+}
+
+void host_add_port(LV2Host* host, uint32_t index, HostPortKind kind, const char* name, uint32_t capacity) {
+    if (index >= HOST_MAX_PORTS) return;
+
+    host->kinds[index] = kind;
+    host->names[index] = name;
+
+    if (kind == HOST_PORT_ATOM_IN || kind == HOST_PORT_ATOM_OUT) {
+        host->atoms[index] = (LV2_Atom_Sequence*)calloc(1, capacity);
+        host->capacities[index] = capacity;
+        host->record[index] = (kind == HOST_PORT_ATOM_OUT);
+        if (kind == HOST_PORT_ATOM_IN) {
+            lv2_atom_forge_init(&host->input_forges[index], &host->map);
+            if (!host->has_input) {
+                host->input_port = index;
+                host->has_input = true;
+            }
+        }
+    }
+}
+
+static void s_open_input(LV2Host* host, uint32_t port) {
+    if (host->input_open[port] || host->kinds[port] != HOST_PORT_ATOM_IN) return;
+
+    lv2_atom_forge_set_buffer(&host->input_forges[port],
+                              (uint8_t*)host->atoms[port],
+                              host->capacities[port]);
+    lv2_atom_forge_sequence_head(&host->input_forges[port], &host->input_frames[port], 0);
+    host->input_open[port] = true;
+}
+
+static void s_open_inputs(LV2Host* host) {
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        s_open_input(host, i);
+    }
+}
+
+bool host_instantiate(LV2Host* host) {
+    host->instance = host->descriptor->instantiate(
+        host->descriptor, host->sample_rate, "", host->features);
+    if (!host->instance) return false;
+
+    if (host->descriptor->extension_data) {
+        host->worker = (const LV2_Worker_Interface*)host->descriptor->extension_data(LV2_WORKER__interface);
+    }
+
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        switch (host->kinds[i]) {
+            case HOST_PORT_CONTROL:
+                host->descriptor->connect_port(host->instance, i, &host->controls[i]);
+                break;
+            case HOST_PORT_ATOM_IN:
+            case HOST_PORT_ATOM_OUT:
+                host->descriptor->connect_port(host->instance, i, host->atoms[i]);
+                break;
+            case HOST_PORT_NONE:
+                break;
+        }
+    }
+
+    s_open_inputs(host);
+    return true;
+}
+
+void host_activate(LV2Host* host) {
+    if (host->descriptor->activate) {
+        host->descriptor->activate(host->instance);
+    }
+}
+
+void host_deactivate(LV2Host* host) {
+    if (host->descriptor->deactivate) {
+        host->descriptor->deactivate(host->instance);
+    }
+}
+
+void host_free(LV2Host* host) {
+    if (host->instance) {
+        host->descriptor->cleanup(host->instance);
+    }
+
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        free(host->atoms[i]);
+    }
+    for (uint32_t i = 0; i < host->num_uris; i++) {
+        free(host->uris[i]);
+    }
+    free(host->events);
+
+    if (host->library) {
+        dlclose(host->library);
+    }
+
+    memset(host, 0, sizeof(LV2Host));
+}
+
+LV2_URID host_map(LV2Host* host, const char* uri) {
+    return s_map_uri(host, uri);
+}
+
+const char* host_unmap(const LV2Host* host, LV2_URID urid) {
+    return (urid > 0 && urid <= host->num_uris) ? host->uris[urid - 1] : NULL;
+}
+
+void host_set_control(LV2Host* host, uint32_t port, float value) {
+    if (port < HOST_MAX_PORTS) host->controls[port] = value;
+}
+
+float host_get_control(const LV2Host* host, uint32_t port) {
+    return port < HOST_MAX_PORTS ? host->controls[port] : 0.0f;
+}
+
+LV2_Atom_Forge* host_input_forge(LV2Host* host) {
+    s_open_input(host, host->input_port);
+    return &host->input_forges[host->input_port];
+}
+
+void host_send_midi(LV2Host* host, uint32_t frame, const uint8_t* msg, uint32_t size) {
+    host_send_midi_to(host, host->input_port, frame, msg, size);
+}
+
+void host_send_midi_to(LV2Host* host, uint32_t port, uint32_t frame, const uint8_t* msg, uint32_t size) {
+    if (port >= HOST_MAX_PORTS || host->kinds[port] != HOST_PORT_ATOM_IN) return;
+
+    s_open_input(host, port);
+    LV2_Atom_Forge* forge = &host->input_forges[port];
+
+    lv2_atom_forge_frame_time(forge, frame);
+    lv2_atom_forge_atom(forge, size, host_map(host, LV2_MIDI__MidiEvent));
+    lv2_atom_forge_write(forge, msg, size);
+}
+
+void host_send_position(LV2Host* host, uint32_t frame, float bpm, float speed) {
+    LV2_Atom_Forge* forge = host_input_forge(host);
+    LV2_Atom_Forge_Frame obj;
+
+    lv2_atom_forge_frame_time(forge, frame);
+    lv2_atom_forge_object(forge, &obj, 0, host_map(host, LV2_TIME__Position));
+    lv2_atom_forge_key(forge, host_map(host, LV2_TIME__beatsPerMinute));
+    lv2_atom_forge_float(forge, bpm);
+    lv2_atom_forge_key(forge, host_map(host, LV2_TIME__speed));
+    lv2_atom_forge_float(forge, speed);
+    lv2_atom_forge_pop(forge, &obj);
+}
+
+static void s_push_event(LV2Host* host, const HostEvent* ev) {
+    if (host->num_events == host->events_capacity) {
+        size_t capacity = host->events_capacity ? host->events_capacity * 2 : 1024;
+        HostEvent* events = (HostEvent*)realloc(host->events, capacity * sizeof(HostEvent));
+        if (!events) return;
+        host->events = events;
+        host->events_capacity = capacity;
+    }
+
+    host->events[host->num_events++] = *ev;
+}
+
+static void s_capture(LV2Host* host, uint32_t port) {
+    const LV2_Atom_Sequence* seq = host->atoms[port];
+    HostEvent ev;
+
+    if (seq->atom.type != host->forge.Sequence) {
+        memset(&ev, 0, sizeof(ev));
+        ev.port = port;
+        ev.frame = host->frame;
+        ev.unwritten = true;
+        s_push_event(host, &ev);
+        return;
+    }
+
+    LV2_ATOM_SEQUENCE_FOREACH(seq, iter) {
+        memset(&ev, 0, sizeof(ev));
+        ev.port = port;
+        ev.frame = host->frame + (uint64_t)iter->time.frames;
+        ev.type = iter->body.type;
+        ev.size = iter->body.size;
+        memcpy(ev.data, LV2_ATOM_BODY_CONST(&iter->body),
+               ev.size < HOST_EVENT_MAX_SIZE ? ev.size : HOST_EVENT_MAX_SIZE);
+        s_push_event(host, &ev);
+    }
+}
+
+void host_run(LV2Host* host, uint32_t n_samples) {
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        if (host->kinds[i] != HOST_PORT_ATOM_IN) continue;
+
+        s_open_input(host, i);
+        lv2_atom_forge_pop(&host->input_forges[i], &host->input_frames[i]);
+        host->input_open[i] = false;
+    }
+
+    // Output buffers: size is the available capacity, as hosts do
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        if (host->kinds[i] == HOST_PORT_ATOM_OUT) {
+            host->atoms[i]->atom.type = 0;
+            host->atoms[i]->atom.size = host->capacities[i] - (uint32_t)sizeof(LV2_Atom);
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (host->rt_enter) host->rt_enter();
+    host->descriptor->run(host->instance, n_samples);
+    if (host->rt_leave) host->rt_leave();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    host->run_ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ull
+                 + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+    host->block_events = 0;
+
+    for (uint32_t i = 0; i < HOST_MAX_PORTS; i++) {
+        if (host->kinds[i] != HOST_PORT_ATOM_OUT) continue;
+
+        if (host->atoms[i]->atom.type == host->forge.Sequence) {
+            LV2_ATOM_SEQUENCE_FOREACH(host->atoms[i], iter) {
+                host->block_events++;
+            }
+        }
+        if (host->record[i]) {
+            s_capture(host, i);
+        }
+    }
+
+    s_run_worker(host);
+
+    host->frame += n_samples;
+    s_open_inputs(host);
+}
+
+void host_run_frames(LV2Host* host, uint64_t total, uint32_t block_size) {
+    while (total > 0) {
+        uint32_t n = total < block_size ? (uint32_t)total : block_size;
+        host_run(host, n);
+        total -= n;
+    }
+}
+
+void host_record(LV2Host* host, uint32_t port, bool enable) {
+    if (port < HOST_MAX_PORTS) host->record[port] = enable;
+}
+
+void host_clear_events(LV2Host* host) {
+    host->num_events = 0;
+}
+
+void host_format_event(const LV2Host* host, const HostEvent* ev, char* buf, size_t size) {
+    const char* port_name = host->names[ev->port] ? host->names[ev->port] : "?";
+
+    if (ev->unwritten) {
+        snprintf(buf, size, "%s %llu unwritten", port_name, (unsigned long long)ev->frame);
+        return;
+    }
+
+    // MIDI events print as "midi", other atoms by their URI fragment
+    const char* type = host_unmap(host, ev->type);
+    const char* hash = type ? strrchr(type, '#') : NULL;
+    const char* type_name = hash ? hash + 1 : (type ? type : "?");
+    if (type && strcmp(type, LV2_MIDI__MidiEvent) == 0) {
+        type_name = "midi";
+    }
+
+    int len = snprintf(buf, size, "%s %llu %s", port_name, (unsigned long long)ev->frame, type_name);
+    uint32_t n = ev->size < HOST_EVENT_MAX_SIZE ? ev->size : HOST_EVENT_MAX_SIZE;
+    for (uint32_t i = 0; i < n && len > 0 && (size_t)len + 4 < size; i++) {
+        len += snprintf(buf + len, size - (size_t)len, " %02x", ev->data[i]);
+    }
+}
+
+bool host_check_golden(const LV2Host* host, const char* path, bool update) {
+    char line[HOST_LINE_SIZE];
+    char expected[HOST_LINE_SIZE];
+
+    if (update) {
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            fprintf(stderr, "host: cannot write %s\n", path);
+            return false;
+        }
+        for (size_t i = 0; i < host->num_events; i++) {
+            host_format_event(host, &host->events[i], line, sizeof(line));
+            fprintf(file, "%s\n", line);
+        }
+        fclose(file);
+        return true;
+    }
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "host: missing golden file %s\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    size_t i = 0;
+    while (fgets(expected, sizeof(expected), file)) {
+        expected[strcspn(expected, "\n")] = '\0';
+
+        if (i >= host->num_events) {
+            fprintf(stderr, "%s:%zu: missing event, expected \"%s\"\n", path, i + 1, expected);
+            ok = false;
+            break;
+        }
+
+        host_format_event(host, &host->events[i], line, sizeof(line));
+        if (strcmp(line, expected) != 0) {
+            fprintf(stderr, "%s:%zu: expected \"%s\"\n%s:%zu:      got \"%s\"\n",
+                    path, i + 1, expected, path, i + 1, line);
+            ok = false;
+            break;
+        }
+        i++;
+    }
+
+    if (ok && i < host->num_events) {
+        host_format_event(host, &host->events[i], line, sizeof(line));
+        fprintf(stderr, "%s:%zu: unexpected extra event \"%s\"\n", path, i + 1, line);
+        ok = false;
+    }
+
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,231 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+#ifndef GRID_SEQ_LV2_HOST_H
+#define GRID_SEQ_LV2_HOST_H
+
+// Minimal headless LV2 host for driving the plugin from tests and
+// benchmarks: URID map, atom port buffers, input sequence building and
+// capture of output events with absolute frame times.
+
+#include <lv2/core/lv2.h>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/forge.h>
+#include <lv2/urid/urid.h>
+#include <lv2/worker/worker.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define HOST_MAX_PORTS 64
+#define HOST_MAX_URIDS 256
+#define HOST_MAX_FEATURES 16
+#define HOST_EVENT_MAX_SIZE 1024
+#define HOST_WORK_QUEUE_SIZE 4096
+
+typedef enum {
+    HOST_PORT_NONE = 0,
+    HOST_PORT_CONTROL,
+    HOST_PORT_ATOM_IN,
+    HOST_PORT_ATOM_OUT
+} HostPortKind;
+
+typedef struct {
+    uint32_t port;
+    uint64_t frame;   // Absolute frame (block start + event time)
+    LV2_URID type;
+    uint32_t size;
+    uint8_t data[HOST_EVENT_MAX_SIZE];
+    bool unwritten;   // Plugin left the output buffer untouched
+} HostEvent;
+
+typedef struct {
+    const LV2_Descriptor* descriptor;
+    LV2_Handle instance;
+    void* library;
+    double sample_rate;
+
+    // URID map
+    char* uris[HOST_MAX_URIDS];
+    uint32_t num_uris;
+    LV2_URID_Map map;
+    LV2_Feature map_feature;
+    const LV2_Feature* features[HOST_MAX_FEATURES + 1];
+    uint32_t num_features;
+
+    // Worker, run synchronously after each block (outside run())
+    LV2_Worker_Schedule schedule;
+    LV2_Feature schedule_feature;
+    const LV2_Worker_Interface* worker;
+    uint8_t work_queue[HOST_WORK_QUEUE_SIZE];
+    uint32_t work_queue_size;
+    uint8_t response_queue[HOST_WORK_QUEUE_SIZE];
+    uint32_t response_queue_size;
+
+    // Real-time checker hooks, present when tests/rtcheck.so is preloaded
+    void (*rt_enter)(void);
+    void (*rt_leave)(void);
+    unsigned (*rt_violations)(void);
+
+    // Ports
+    HostPortKind kinds[HOST_MAX_PORTS];
+    const char* names[HOST_MAX_PORTS];
+    float controls[HOST_MAX_PORTS];
+    LV2_Atom_Sequence* atoms[HOST_MAX_PORTS];
+    uint32_t capacities[HOST_MAX_PORTS];
+    bool record[HOST_MAX_PORTS];
+
+    // Input sequences under construction, one per atom input port.
+    // Events sent without a port go to the first atom input.
+    uint32_t input_port;
+    bool has_input;
+    LV2_Atom_Forge forge;
+    LV2_Atom_Forge input_forges[HOST_MAX_PORTS];
+    LV2_Atom_Forge_Frame input_frames[HOST_MAX_PORTS];
+    bool input_open[HOST_MAX_PORTS];
+
+    // Transport
+    uint64_t frame;
+
+    // Last block: time spent in run() and events written to all outputs
+    uint64_t run_ns;
+    uint32_t block_events;
+
+    // Captured output
+    HostEvent* events;
+    size_t num_events;
+    size_t events_capacity;
+} LV2Host;
+
+/**
+ * Load a plugin binary and return its first descriptor.
+ *
+ * @return Descriptor or NULL if the library or symbol is missing
+ */
+const LV2_Descriptor* host_load(LV2Host* host, const char* path);
+
+/**
+ * Initialize the host for a descriptor (loaded or statically linked).
+ */
+void host_init(LV2Host* host, const LV2_Descriptor* descriptor, double sample_rate);
+
+/**
+ * Add a feature passed to instantiate(). Must be called before
+ * host_instantiate().
+ */
+void host_add_feature(LV2Host* host, const LV2_Feature* feature);
+
+/**
+ * Number of real-time violations reported by the preloaded checker so far.
+ *
+ * @return Violation count, or 0 when the checker is not loaded
+ */
+unsigned host_rt_violations(const LV2Host* host);
+
+/**
+ * Whether run() calls are being checked by the preloaded rtcheck shim.
+ */
+bool host_rt_checking(const LV2Host* host);
+
+/**
+ * Declare a port. Atom ports get a buffer of the given capacity in bytes.
+ */
+void host_add_port(LV2Host* host, uint32_t index, HostPortKind kind, const char* name, uint32_t capacity);
+
+/**
+ * Instantiate the plugin and connect all declared ports.
+ *
+ * @return true on success
+ */
+bool host_instantiate(LV2Host* host);
+
+void host_activate(LV2Host* host);
+void host_deactivate(LV2Host* host);
+void host_free(LV2Host* host);
+
+/**
+ * Map a URI with the host's URID map.
+ */
+LV2_URID host_map(LV2Host* host, const char* uri);
+
+/**
+ * Look up the URI for a URID.
+ */
+const char* host_unmap(const LV2Host* host, LV2_URID urid);
+
+/**
+ * Set the value of a control input port.
+ */
+void host_set_control(LV2Host* host, uint32_t port, float value);
+
+float host_get_control(const LV2Host* host, uint32_t port);
+
+/**
+ * Forge for appending custom atoms to the input sequence. Write the event
+ * header with lv2_atom_forge_frame_time() first.
+ */
+LV2_Atom_Forge* host_input_forge(LV2Host* host);
+
+/**
+ * Append a raw MIDI message to the input sequence of the next block.
+ */
+void host_send_midi(LV2Host* host, uint32_t frame, const uint8_t* msg, uint32_t size);
+
+/**
+ * Append a raw MIDI message to the input sequence of a given atom input port.
+ */
+void host_send_midi_to(LV2Host* host, uint32_t port, uint32_t frame, const uint8_t* msg, uint32_t size);
+
+/**
+ * Append a time:Position object (tempo and transport speed).
+ */
+void host_send_position(LV2Host* host, uint32_t frame, float bpm, float speed);
+
+/**
+ * Run one block. Output events of recorded ports are appended to the
+ * capture list; the input sequence is cleared afterwards. The duration of
+ * the run() call and the number of events written to all atom outputs are
+ * left in run_ns and block_events. Work scheduled during the block is
+ * performed before returning.
+ */
+void host_run(LV2Host* host, uint32_t n_samples);
+
+/**
+ * Run blocks of block_size until total frames have been processed.
+ */
+void host_run_frames(LV2Host* host, uint64_t total, uint32_t block_size);
+
+/**
+ * Select whether events of an output port are captured.
+ */
+void host_record(LV2Host* host, uint32_t port, bool enable);
+
+/**
+ * Discard captured events.
+ */
+void host_clear_events(LV2Host* host);
+
+/**
+ * Format a captured event as one golden-file line (without newline).
+ */
+void host_format_event(const LV2Host* host, const HostEvent* ev, char* buf, size_t size);
+
+/**
+ * Compare captured events against a golden file, one event per line.
+ * With update set, the golden file is rewritten instead.
+ *
+ * @return true if the events match
+ */
+bool host_check_golden(const LV2Host* host, const char* path, bool update);
+
+#endif // GRID_SEQ_LV2_HOST_H
@@ -0,0 +1,332 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+// rtcheck: LD_PRELOAD shim that reports real-time safety violations.
+//
+// Allocation, locking, blocking system calls and stdio are interposed. A
+// call made while the calling thread is between rtcheck_enter() and
+// rtcheck_leave() (the host brackets every run() with these) is reported
+// on stderr with a backtrace and counted. Set RTCHECK_ABORT=1 to abort on
+// the first violation instead, e.g. under a debugger.
+//
+// Usage: LD_PRELOAD=rtcheck.so test_plugin grid_seq.so tests/golden
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RTCHECK_MAX_REPORTS 20
+#define RTCHECK_MAX_FRAMES 32
+
+// glibc entry points behind the public allocator symbols. Using these
+// avoids calling dlsym() (which may allocate) from inside malloc().
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static __thread int s_in_run;
+static __thread int s_reporting;
+static unsigned s_violations;
+static int s_abort;
+
+static ssize_t (*real_write)(int, const void*, size_t);
+static ssize_t (*real_read)(int, void*, size_t);
+static int (*real_open)(const char*, int, ...);
+static int (*real_close)(int);
+static int (*real_usleep)(useconds_t);
+static int (*real_nanosleep)(const struct timespec*, struct timespec*);
+static int (*real_poll)(struct pollfd*, nfds_t, int);
+static int (*real_select)(int, fd_set*, fd_set*, fd_set*, struct timeval*);
+static int (*real_pthread_mutex_lock)(pthread_mutex_t*);
+static int (*real_pthread_cond_wait)(pthread_cond_t*, pthread_mutex_t*);
+static FILE* (*real_fopen)(const char*, const char*);
+static int (*real_fclose)(FILE*);
+static int (*real_vfprintf)(FILE*, const char*, va_list);
+static int (*real_fputs)(const char*, FILE*);
+static int (*real_fputc)(int, FILE*);
+static int (*real_puts)(const char*);
+static size_t (*real_fwrite)(const void*, size_t, size_t, FILE*);
+static int (*real_fflush)(FILE*);
+
+#define RESOLVE(name) (*(void**)(&real_##name) = dlsym(RTLD_NEXT, #name))
+
+static void s_resolve(void) {
+    RESOLVE(write);
+    RESOLVE(read);
+    RESOLVE(open);
+    RESOLVE(close);
+    RESOLVE(usleep);
+    RESOLVE(nanosleep);
+    RESOLVE(poll);
+    RESOLVE(select);
+    RESOLVE(pthread_mutex_lock);
+    RESOLVE(pthread_cond_wait);
+    RESOLVE(fopen);
+    RESOLVE(fclose);
+    RESOLVE(vfprintf);
+    RESOLVE(fputs);
+    RESOLVE(fputc);
+    RESOLVE(puts);
+    RESOLVE(fwrite);
+    RESOLVE(fflush);
+}
+
+__attribute__((constructor))
+static void s_init(void) {
+    s_resolve();
+
+    const char* env = getenv("RTCHECK_ABORT");
+    s_abort = env && env[0] == '1';
+
+    // The first backtrace() loads the unwinder, which allocates
+    void* frames[2];
+    backtrace(frames, 2);
+}
+
+static void s_violation(const char* what) {
+    if (!s_in_run || s_reporting) return;
+    s_reporting = 1;
+
+    unsigned count = __atomic_add_fetch(&s_violations, 1, __ATOMIC_RELAXED);
+    if (count <= RTCHECK_MAX_REPORTS && real_write) {
+        char line[128];
+        int len = snprintf(line, sizeof(line), "rtcheck: %s() called inside run()\n", what);
+        if (len > 0) real_write(STDERR_FILENO, line, (size_t)len);
+
+        void* frames[RTCHECK_MAX_FRAMES];
+        int depth = backtrace(frames, RTCHECK_MAX_FRAMES);
+        if (depth > 2) {
+            // Skip s_violation() and the interposed function
+            backtrace_symbols_fd(frames + 2, depth - 2, STDERR_FILENO);
+        }
+    }
+
+    if (s_abort) abort();
+    s_reporting = 0;
+}
+
+// Entry points looked up by the test host
+
+void rtcheck_enter(void) {
+    s_in_run = 1;
+}
+
+void rtcheck_leave(void) {
+    s_in_run = 0;
+}
+
+unsigned rtcheck_violations(void) {
+    return __atomic_load_n(&s_violations, __ATOMIC_RELAXED);
+}
+
+// Allocation
+
+void* malloc(size_t size) {
+    s_violation("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    s_violation("calloc");
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    s_violation("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr) s_violation("free");
+    __libc_free(ptr);
+}
+
+// Locks
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    s_violation("pthread_mutex_lock");
+    if (!real_pthread_mutex_lock) s_resolve();
+    return real_pthread_mutex_lock(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    s_violation("pthread_cond_wait");
+    if (!real_pthread_cond_wait) s_resolve();
+    return real_pthread_cond_wait(cond, mutex);
+}
+
+// Blocking system calls
+
+ssize_t write(int fd, const void* buf, size_t count) {
+    s_violation("write");
+    if (!real_write) s_resolve();
+    return real_write(fd, buf, count);
+}
+
+ssize_t read(int fd, void* buf, size_t count) {
+    s_violation("read");
+    if (!real_read) s_resolve();
+    return real_read(fd, buf, count);
+}
+
+int open(const char* path, int flags, ...) {
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = (mode_t)va_arg(args, int);
+        va_end(args);
+    }
+
+    s_violation("open");
+    if (!real_open) s_resolve();
+    return real_open(path, flags, mode);
+}
+
+int close(int fd) {
+    s_violation("close");
+    if (!real_close) s_resolve();
+    return real_close(fd);
+}
+
+int usleep(useconds_t usec) {
+    s_violation("usleep");
+    if (!real_usleep) s_resolve();
+    return real_usleep(usec);
+}
+
+int nanosleep(const struct timespec* req, struct timespec* rem) {
+    s_violation("nanosleep");
+    if (!real_nanosleep) s_resolve();
+    return real_nanosleep(req, rem);
+}
+
+int poll(struct pollfd* fds, nfds_t nfds, int timeout) {
+    s_violation("poll");
+    if (!real_poll) s_resolve();
+    return real_poll(fds, nfds, timeout);
+}
+
+int select(int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, struct timeval* timeout) {
+    s_violation("select");
+    if (!real_select) s_resolve();
+    return real_select(nfds, readfds, writefds, exceptfds, timeout);
+}
+
+// Stdio (compilers turn simple printf calls into fputs/fwrite/fputc/puts)
+
+FILE* fopen(const char* path, const char* mode) {
+    s_violation("fopen");
+    if (!real_fopen) s_resolve();
+    return real_fopen(path, mode);
+}
+
+int fclose(FILE* stream) {
+    s_violation("fclose");
+    if (!real_fclose) s_resolve();
+    return real_fclose(stream);
+}
+
+int vfprintf(FILE* stream, const char* format, va_list args) {
+    s_violation("vfprintf");
+    if (!real_vfprintf) s_resolve();
+    return real_vfprintf(stream, format, args);
+}
+
+int fprintf(FILE* stream, const char* format, ...) {
+    s_violation("fprintf");
+    if (!real_vfprintf) s_resolve();
+
+    va_list args;
+    va_start(args, format);
+    int ret = real_vfprintf(stream, format, args);
+    va_end(args);
+    return ret;
+}
+
+int printf(const char* format, ...) {
+    s_violation("printf");
+    if (!real_vfprintf) s_resolve();
+
+    va_list args;
+    va_start(args, format);
+    int ret = real_vfprintf(stdout, format, args);
+    va_end(args);
+    return ret;
+}
+
+// Fortified builds (_FORTIFY_SOURCE) call these instead
+int __fprintf_chk(FILE* stream, int flag, const char* format, ...) {
+    (void)flag;
+    s_violation("fprintf");
+    if (!real_vfprintf) s_resolve();
+
+    va_list args;
+    va_start(args, format);
+    int ret = real_vfprintf(stream, format, args);
+    va_end(args);
+    return ret;
+}
+
+int __printf_chk(int flag, const char* format, ...) {
+    (void)flag;
+    s_violation("printf");
+    if (!real_vfprintf) s_resolve();
+
+    va_list args;
+    va_start(args, format);
+    int ret = real_vfprintf(stdout, format, args);
+    va_end(args);
+    return ret;
+}
+
+int fputs(const char* str, FILE* stream) {
+    s_violation("fputs");
+    if (!real_fputs) s_resolve();
+    return real_fputs(str, stream);
+}
+
+int fputc(int c, FILE* stream) {
+    s_violation("fputc");
+    if (!real_fputc) s_resolve();
+    return real_fputc(c, stream);
+}
+
+int puts(const char* str) {
+    s_violation("puts");
+    if (!real_puts) s_resolve();
+    return real_puts(str);
+}
+
+size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream) {
+    s_violation("fwrite");
+    if (!real_fwrite) s_resolve();
+    return real_fwrite(ptr, size, nmemb, stream);
+}
+
+int fflush(FILE* stream) {
+    s_violation("fflush");
+    if (!real_fflush) s_resolve();
+    return real_fflush(stream);
+}
@@ -0,0 +1,246 @@
+/*
+ * grid-seq - Grid-based MIDI sequencer LV2 plugin
+ *
+ * Copyright (C) 2025 Danny
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE.
+ */
+
+// grid-seq-render: render .gsp patterns to MIDI faster than real time,
+// with the plugin's own timing, optionally on a pool of threads
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "grid_seq/common.h"
+#include "state.h"
+#include "pattern_file.h"
+#include "render.h"
+#include "smf.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+#define SMF_DIVISION 960
+
+typedef struct {
+    const char* out_dir;
+    double bpm;
+    double sample_rate;
+    uint32_t block_size;
+    uint32_t steps;          // 0 renders one pass of each pattern
+    bool note_offs;
+    bool quiet;
+} RenderOptions;
+
+// Shared by the workers: the next file to take and the totals
+typedef struct {
+    const RenderOptions* options;
+    char** files;
+    int num_files;
+    int next;
+    pthread_mutex_t lock;    // Guards next, the totals and stdout
+    uint32_t ok;
+    uint32_t failed;
+    uint64_t events;
+} RenderJobs;
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [options] FILE.gsp...\n"
+        "\n"
+        "  -o DIR   Write DIR/<name>.mid for each pattern (default: events on stdout)\n"
+        "  -t BPM   Tempo (default 120)\n"
+        "  -R RATE  Sample rate in Hz (default 48000)\n"
+        "  -b N     Block size in frames, the host's to match it (default %d)\n"
+        "  -l N     Length in steps (default: one pass of each pattern)\n"
+        "  -n       Note Ons only (the plugin's MIDI filter)\n"
+        "  -j N     Render on N threads (1-%d, default 1)\n"
+        "  -q       Only print the final summary\n",
+        prog, RENDER_DEFAULT_BLOCK, MAX_THREADS);
+}
+
+static const char* base_name(const char* path, char* buf, size_t size) {
+    const char* slash = strrchr(path, '/');
+    const char* name = slash ? slash + 1 : path;
+
+    snprintf(buf, size, "%s", name);
+    char* dot = strrchr(buf, '.');
+    if (dot && dot != buf) *dot = '\0';
+
+    return buf;
+}
+
+static bool read_pattern(const char* path, GridSeqState* state, double sample_rate) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    state_init(state, sample_rate);
+    GridSeqError err = pattern_file_read(file, state);
+    fclose(file);
+    return err == GS_OK;
+}
+
+// The track lasts `frames`, the rendered steps, whatever the last event
+static bool write_smf(const RenderOptions* options, const char* path, const RenderOutput* out,
+                      uint64_t frames, SmfEvent** smf, size_t* smf_capacity) {
+    if (out->count > *smf_capacity) {
+        SmfEvent* events = (SmfEvent*)realloc(*smf, out->count * sizeof(SmfEvent));
+        if (!events) return false;
+        *smf = events;
+        *smf_capacity = out->count;
+    }
+
+    // Frames to ticks at the render tempo
+    const double ticks_per_frame = SMF_DIVISION * options->bpm / (60.0 * options->sample_rate);
+    for (size_t i = 0; i < out->count; i++) {
+        const RenderEvent* ev = &out->events[i];
+        (*smf)[i].tick = (uint32_t)((double)ev->frame * ticks_per_frame + 0.5);
+        (*smf)[i].size = ev->size;
+        memcpy((*smf)[i].msg, ev->msg, sizeof(ev->msg));
+    }
+
+    char name[256];
+    char out_path[1024];
+    snprintf(out_path, sizeof(out_path), "%s/%s.mid", options->out_dir,
+             base_name(path, name, sizeof(name)));
+
+    FILE* file = fopen(out_path, "wb");
+    if (!file) return false;
+
+    const uint32_t end_tick = (uint32_t)((double)frames * ticks_per_frame + 0.5);
+    GridSeqError err = smf_write(file, *smf, out->count, end_tick, SMF_DIVISION, options->bpm);
+    return fclose(file) == 0 && err == GS_OK;
+}
+
+static void print_events(const char* path, const RenderOutput* out) {
+    printf("# %s\n", path);
+    for (size_t i = 0; i < out->count; i++) {
+        const RenderEvent* ev = &out->events[i];
+        printf("%llu", (unsigned long long)ev->frame);
+        for (uint8_t b = 0; b < ev->size; b++) printf(" %02X", ev->msg[b]);
+        printf("\n");
+    }
+}
+
+// Worker: one engine, reused for every pattern it takes
+static void* render_worker(void* data) {
+    RenderJobs* jobs = (RenderJobs*)data;
+    const RenderOptions* options = jobs->options;
+
+    GridSeqState* pattern = (GridSeqState*)malloc(sizeof(GridSeqState));
+    RenderEngine* engine = (RenderEngine*)malloc(sizeof(RenderEngine));
+    RenderOutput out = {NULL, 0, 0};
+    SmfEvent* smf = NULL;
+    size_t smf_capacity = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&jobs->lock);
+        const int i = jobs->next < jobs->num_files ? jobs->next++ : -1;
+        pthread_mutex_unlock(&jobs->lock);
+        if (i < 0) break;
+
+        const char* path = jobs->files[i];
+        bool ok = pattern && engine && read_pattern(path, pattern, options->sample_rate);
+        if (ok) {
+            render_init(engine, pattern, options->sample_rate, options->bpm,
+                        options->block_size, options->note_offs);
+            const uint32_t steps = options->steps ? options->steps : pattern->sequence_length;
+
+            const uint64_t frames = render_step_frames(engine, steps);
+            out.count = 0;
+            ok = render_run(engine, frames, &out) == GS_OK;
+            if (ok && options->out_dir) {
+                ok = write_smf(options, path, &out, frames, &smf, &smf_capacity);
+            }
+        }
+
+        pthread_mutex_lock(&jobs->lock);
+        if (ok) {
+            jobs->ok++;
+            jobs->events += out.count;
+            if (!options->out_dir) {
+                print_events(path, &out);
+            } else if (!options->quiet) {
+                printf("%s: %zu events\n", path, out.count);
+            }
+        } else {
+            jobs->failed++;
+            fprintf(stderr, "grid-seq-render: %s: cannot render\n", path);
+        }
+        pthread_mutex_unlock(&jobs->lock);
+    }
+
+    free(smf);
+    render_output_free(&out);
+    free(engine);
+    free(pattern);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    RenderOptions options = {NULL, 120.0, 48000.0, RENDER_DEFAULT_BLOCK, 0, true, false};
+    int threads = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:t:R:b:l:nj:qh")) != -1) {
+        switch (opt) {
+            case 'o': options.out_dir = optarg; break;
+            case 't': options.bpm = atof(optarg); break;
+            case 'R': options.sample_rate = atof(optarg); break;
+            case 'b': options.block_size = (uint32_t)atoi(optarg); break;
+            case 'l': options.steps = (uint32_t)atoi(optarg); break;
+            case 'n': options.note_offs = false; break;
+            case 'j': threads = atoi(optarg); break;
+            case 'q': options.quiet = true; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc || options.bpm <= 0.0 || options.sample_rate <= 0.0 ||
+        options.block_size < 1 || options.block_size > 8192 || threads < 1 || threads > MAX_THREADS) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    RenderJobs jobs;
+    memset(&jobs, 0, sizeof(jobs));
+    jobs.options = &options;
+    jobs.files = argv + optind;
+    jobs.num_files = argc - optind;
+    pthread_mutex_init(&jobs.lock, NULL);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t pool[MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&pool[started], NULL, render_worker, &jobs) == 0) started++;
+    }
+    render_worker(&jobs);
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    fprintf(options.out_dir ? stdout : stderr,
+            "%u patterns rendered, %u failed, %llu events in %.3f s (%.0f patterns/s)\n",
+            jobs.ok, jobs.failed, (unsigned long long)jobs.events, elapsed,
+            elapsed > 0.0 ? (double)(jobs.ok + jobs.failed) / elapsed : 0.0);
+
+    pthread_mutex_destroy(&jobs.lock);
+    return jobs.failed ? 1 : 0;
+}